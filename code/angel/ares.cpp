@@ -160,6 +160,8 @@ namespace Iridium::Angel
         {
             const Rc<Stream>& input = static_cast<AresArchive*>(ctx)->GetInput();
 
+            input->Advise(Entry.GetOffset(), Entry.GetSize(), AccessPattern::WillNeed);
+
             return MakeRc<PartialStream>(Entry.GetOffset(), Entry.GetSize(), input);
         }
 
@@ -1,5 +1,6 @@
 #include "dave.h"
 
+#include "asset/compressibility.h"
 #include "asset/path.h"
 #include "asset/stream.h"
 #include "asset/stream/decode.h"
@@ -202,6 +203,8 @@ namespace Iridium::Angel
             u32 disk_size = Entry.GetOnDiskSize();
             u32 offset = Entry.GetOffset();
 
+            input->Advise(offset, disk_size, AccessPattern::WillNeed);
+
             if (mem_size != disk_size)
             {
                 return MakeRc<DecodeStream>(
@@ -335,6 +338,9 @@ namespace Iridium::Angel
             offset = bits::align<u32>(offset + names_size, data_alignment);
         }
 
+        // Shared between files, so its workers are only started once
+        ParallelDeflateTransform deflater;
+
         for (u32 i = 0; i < file_count; ++i)
         {
             StringView file = files[i];
@@ -348,15 +354,21 @@ namespace Iridium::Angel
             u32 data_size = 0;
             u32 raw_size = 0;
 
+            bool compressed = ShouldCompress(file, *input) && input->TrySeek(0);
+
+            if (compressed)
             {
                 output->Seek(offset, SeekWhence::Set);
-                EncodeStream encoder(output, MakeUnique<DeflateTransform>());
+                deflater.Reset();
+                EncodeStream encoder(output, deflater);
                 data_size = static_cast<u32>(input->CopyTo(encoder));
                 encoder.Flush();
                 raw_size = static_cast<u32>(encoder.Size().get(0));
+
+                compressed = raw_size < data_size;
             }
 
-            if (raw_size >= data_size)
+            if (!compressed)
             {
                 output->Seek(offset, SeekWhence::Set);
 
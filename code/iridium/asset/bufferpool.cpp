@@ -0,0 +1,98 @@
+#include "bufferpool.h"
+
+#include "core/mutex.h"
+
+namespace Iridium
+{
+    // Number of free buffers kept for each size
+    static constexpr usize MaxFreeBuffers = 8;
+
+    static constexpr usize GetSizeClass(usize size)
+    {
+        usize index = 0;
+
+        while ((PooledBuffer::MinPooledSize << index) < size)
+            ++index;
+
+        return index;
+    }
+
+    struct BufferPool
+    {
+        Mutex Lock;
+
+        // Free buffers for each power of two from MinPooledSize to MaxPooledSize
+        Vec<u8*> Free[GetSizeClass(PooledBuffer::MaxPooledSize) + 1];
+
+        ~BufferPool()
+        {
+            for (Vec<u8*>& buffers : Free)
+            {
+                for (u8* buffer : buffers)
+                    delete[] buffer;
+            }
+        }
+    };
+
+    static BufferPool& GetBufferPool()
+    {
+        static BufferPool pool;
+
+        return pool;
+    }
+
+    PooledBuffer::PooledBuffer(usize size)
+    {
+        if (size > MaxPooledSize)
+        {
+            data_ = new u8[size];
+            size_ = size;
+
+            return;
+        }
+
+        usize const index = GetSizeClass(size);
+
+        size_ = MinPooledSize << index;
+
+        {
+            BufferPool& pool = GetBufferPool();
+            MutexGuard lock(pool.Lock);
+
+            if (!pool.Free[index].empty())
+            {
+                data_ = pool.Free[index].back();
+                pool.Free[index].pop_back();
+
+                return;
+            }
+        }
+
+        data_ = new u8[size_];
+    }
+
+    void PooledBuffer::Release()
+    {
+        if (data_ == nullptr)
+            return;
+
+        if (size_ <= MaxPooledSize)
+        {
+            usize const index = GetSizeClass(size_);
+
+            BufferPool& pool = GetBufferPool();
+            MutexGuard lock(pool.Lock);
+
+            if (pool.Free[index].size() < MaxFreeBuffers)
+            {
+                pool.Free[index].push_back(data_);
+                data_ = nullptr;
+            }
+        }
+
+        delete[] data_;
+
+        data_ = nullptr;
+        size_ = 0;
+    }
+} // namespace Iridium
@@ -0,0 +1,82 @@
+#pragma once
+
+namespace Iridium
+{
+    // A buffer borrowed from a process wide pool, and returned to it once destroyed
+    // Sizes are rounded up to a power of two, and only buffers up to MaxPooledSize are kept for reuse
+    class PooledBuffer final
+    {
+    public:
+        static constexpr usize MinPooledSize = 0x1000;
+        static constexpr usize MaxPooledSize = 0x100000;
+
+        PooledBuffer() = default;
+        explicit PooledBuffer(usize size);
+        ~PooledBuffer();
+
+        PooledBuffer(PooledBuffer&& other) noexcept;
+        PooledBuffer& operator=(PooledBuffer&& other) noexcept;
+
+        u8* get() const;
+        usize size() const;
+
+        u8& operator[](usize index) const;
+
+        explicit operator bool() const;
+
+    private:
+        u8* data_ {nullptr};
+        usize size_ {0};
+
+        void Release();
+    };
+
+    inline PooledBuffer::PooledBuffer(PooledBuffer&& other) noexcept
+        : data_(other.data_)
+        , size_(other.size_)
+    {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    inline PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Release();
+
+            data_ = other.data_;
+            size_ = other.size_;
+
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+
+        return *this;
+    }
+
+    inline PooledBuffer::~PooledBuffer()
+    {
+        Release();
+    }
+
+    inline u8* PooledBuffer::get() const
+    {
+        return data_;
+    }
+
+    inline usize PooledBuffer::size() const
+    {
+        return size_;
+    }
+
+    inline u8& PooledBuffer::operator[](usize index) const
+    {
+        return data_[index];
+    }
+
+    inline PooledBuffer::operator bool() const
+    {
+        return data_ != nullptr;
+    }
+} // namespace Iridium
@@ -0,0 +1,140 @@
+#include "compressibility.h"
+
+#include "bufferpool.h"
+#include "path.h"
+#include "stream.h"
+#include "transform/deflate.h"
+
+#include <cmath>
+
+namespace Iridium
+{
+    struct ExtensionPolicy
+    {
+        StringView Extension;
+        CompressionPolicy Policy;
+    };
+
+    // Sorted by extension
+    static const ExtensionPolicy ExtensionPolicies[] {
+        {"7z", CompressionPolicy::Never},
+        {"aac", CompressionPolicy::Never},
+        {"bik", CompressionPolicy::Never},
+        {"bk2", CompressionPolicy::Never},
+        {"cfg", CompressionPolicy::Always},
+        {"csv", CompressionPolicy::Always},
+        {"gz", CompressionPolicy::Never},
+        {"ini", CompressionPolicy::Always},
+        {"jpeg", CompressionPolicy::Never},
+        {"jpg", CompressionPolicy::Never},
+        {"json", CompressionPolicy::Always},
+        {"lua", CompressionPolicy::Always},
+        {"mp3", CompressionPolicy::Never},
+        {"mp4", CompressionPolicy::Never},
+        {"ogg", CompressionPolicy::Never},
+        {"opus", CompressionPolicy::Never},
+        {"png", CompressionPolicy::Never},
+        {"rar", CompressionPolicy::Never},
+        {"txt", CompressionPolicy::Always},
+        {"webm", CompressionPolicy::Never},
+        {"webp", CompressionPolicy::Never},
+        {"wma", CompressionPolicy::Never},
+        {"xma", CompressionPolicy::Never},
+        {"xml", CompressionPolicy::Always},
+        {"xwma", CompressionPolicy::Never},
+        {"ydd", CompressionPolicy::Never},
+        {"ydr", CompressionPolicy::Never},
+        {"yft", CompressionPolicy::Never},
+        {"ytd", CompressionPolicy::Never},
+        {"zip", CompressionPolicy::Never},
+        {"zst", CompressionPolicy::Never},
+    };
+
+    CompressionPolicy GetCompressionPolicy(StringView path)
+    {
+        usize const dot = path.find_last_of("./\\");
+
+        if ((dot == StringView::npos) || (path[dot] != '.'))
+            return CompressionPolicy::Probe;
+
+        char extension[8];
+        usize const len = path.size() - dot - 1;
+
+        if (len > sizeof(extension))
+            return CompressionPolicy::Probe;
+
+        for (usize i = 0; i < len; ++i)
+            extension[i] = static_cast<char>(NormalizeCaseAndSlash[static_cast<unsigned char>(path[dot + 1 + i])]);
+
+        StringView const key(extension, len);
+
+        const ExtensionPolicy* const end = std::end(ExtensionPolicies);
+        const ExtensionPolicy* const find = std::lower_bound(std::begin(ExtensionPolicies), end, key,
+            [](const ExtensionPolicy& lhs, StringView rhs) { return lhs.Extension < rhs; });
+
+        return ((find != end) && (find->Extension == key)) ? find->Policy : CompressionPolicy::Probe;
+    }
+
+    bool IsLikelyCompressible(const u8* data, usize len)
+    {
+        if (len == 0)
+            return true;
+
+        u32 counts[256] {};
+
+        for (usize i = 0; i < len; ++i)
+            ++counts[data[i]];
+
+        double entropy = 0.0;
+
+        for (u32 count : counts)
+        {
+            if (count)
+            {
+                double const p = double(count) / double(len);
+
+                entropy -= p * std::log2(p);
+            }
+        }
+
+        // Skewed byte frequencies alone are enough for deflate to make a difference
+        if (entropy < 7.0)
+            return true;
+
+        // Evenly spread bytes can still contain repeats, so do a quick trial compression to find out
+        PooledBuffer output(len);
+
+        DeflateTransform deflater(-MAX_WBITS, Z_BEST_SPEED);
+
+        deflater.NextIn = data;
+        deflater.AvailIn = len;
+        deflater.NextOut = output.get();
+        deflater.AvailOut = len;
+        deflater.Finished = true;
+
+        if (!deflater.Update() || deflater.AvailIn)
+            return false;
+
+        // Require at least a 3% saving
+        return (len - deflater.AvailOut) * 32 < len * 31;
+    }
+
+    bool ShouldCompress(StringView path, Stream& input)
+    {
+        switch (GetCompressionPolicy(path))
+        {
+            case CompressionPolicy::Always: return true;
+            case CompressionPolicy::Never: return false;
+            case CompressionPolicy::Probe: break;
+        }
+
+        // The first 64KB is enough to tell most formats apart, and quick to compress
+        usize const sample_size = 0x10000;
+
+        PooledBuffer sample(sample_size);
+
+        usize const len = input.ReadBulk(sample.get(), sample_size, 0);
+
+        return IsLikelyCompressible(sample.get(), len);
+    }
+} // namespace Iridium
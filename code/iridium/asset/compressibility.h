@@ -0,0 +1,23 @@
+#pragma once
+
+namespace Iridium
+{
+    class Stream;
+
+    enum class CompressionPolicy : u8
+    {
+        Probe,  // Decide from a sample of the contents
+        Always, // Known to compress well
+        Never,  // Already compressed, so only worth storing
+    };
+
+    // Looks up the policy for a file from its extension
+    CompressionPolicy GetCompressionPolicy(StringView path);
+
+    // Estimates whether compressing a block of data would save enough to be worthwhile
+    bool IsLikelyCompressible(const u8* data, usize len);
+
+    // Decides whether a file is worth compressing, before spending the time to compress all of it
+    // Files with no fixed policy are judged by a sample read from the start, which may move the stream position
+    bool ShouldCompress(StringView path, Stream& input);
+} // namespace Iridium
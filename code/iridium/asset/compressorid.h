@@ -10,6 +10,7 @@ namespace Iridium
         LZSS,
         LZXD,  // XCompress
         Oodle, // Leviathan, Kraken, Mermaid, Selkie
+        Zstd,
 
         // BZip2,
         // Deflated64,
@@ -0,0 +1,214 @@
+#include "loose.h"
+
+#include "asset/findhandle.h"
+#include "asset/platform_io.h"
+#include "asset/stream.h"
+
+namespace Iridium
+{
+    struct LooseFileNode final : VFS::FixedFileNode<u64>
+    {
+        using FixedFileNode::FixedFileNode;
+
+        Rc<Stream> Open(void* ctx, bool /*read_only*/) override
+        {
+            String path = static_cast<LooseFileDevice*>(ctx)->GetRoot();
+
+            usize const root_len = path.size();
+
+            for (const VFS::Node* n = this; n; n = n->ParentFolder)
+            {
+                StringView const name = n->GetName();
+
+                path.insert(root_len, name.data(), name.size());
+            }
+
+            return PlatformOpenFile(path, true);
+        }
+
+        bool Stat(void* /*ctx*/, FolderEntry& entry) override
+        {
+            entry.Size = Entry;
+
+            return true;
+        }
+    };
+
+    LooseFileDevice::LooseFileDevice(String root)
+        : root_(std::move(root))
+    {
+        if (!root_.empty() && root_.back() != '/')
+            root_.push_back('/');
+
+        vfs_.FileContext = this;
+    }
+
+    bool LooseFileDevice::RefreshFileList()
+    {
+        if (vfs_.Locked())
+            return false;
+
+        vfs_.Clear();
+
+        // Start watching first, so nothing is missed between the scan and the first Refresh
+        watcher_ = PlatformCreateFileSystemWatcher(root_,
+            static_cast<NotifyFilters>(
+                NotifyFilter::FileName | NotifyFilter::FolderName | NotifyFilter::Size | NotifyFilter::LastWrite));
+
+        AddFolder({});
+
+        rescan_ = false;
+
+        return true;
+    }
+
+    bool LooseFileDevice::Refresh(u32 timeout)
+    {
+        bool changed = false;
+
+        if (watcher_)
+        {
+            while (watcher_->Poll(*this, timeout))
+            {
+                changed = true;
+                timeout = 0;
+            }
+        }
+
+        if (rescan_ && !vfs_.Locked())
+        {
+            RefreshFileList();
+
+            changed = true;
+        }
+
+        return changed;
+    }
+
+    void LooseFileDevice::OnAdded(StringView name)
+    {
+        if (vfs_.Locked())
+        {
+            rescan_ = true;
+
+            return;
+        }
+
+        // Folders moved in from elsewhere only report the folder itself
+        // Anything already added is skipped by AddFile, so it is fine if the contents are reported as well
+        if (String path = Concat(name, "/"); PlatformFolderExists(Concat(root_, path)))
+            AddFolder(path);
+        else
+            AddEntry(name);
+    }
+
+    void LooseFileDevice::OnRemoved(StringView name)
+    {
+        if (vfs_.Locked())
+        {
+            rescan_ = true;
+
+            return;
+        }
+
+        if (!vfs_.Delete(name))
+            vfs_.DeleteFolder(Concat(name, "/"));
+    }
+
+    void LooseFileDevice::OnModified(StringView name)
+    {
+        if (vfs_.Locked())
+        {
+            rescan_ = true;
+
+            return;
+        }
+
+        if (vfs_.Delete(name))
+        {
+            AddEntry(name);
+        }
+        else if (String path = Concat(name, "/"); PlatformFolderExists(Concat(root_, path)))
+        {
+            // A folder was replaced, so its old contents may not have been removed
+            vfs_.DeleteFolder(path);
+
+            AddFolder(path);
+        }
+        else
+        {
+            AddEntry(name);
+        }
+    }
+
+    void LooseFileDevice::OnRenamed(StringView from, StringView to)
+    {
+        if (vfs_.Locked())
+        {
+            rescan_ = true;
+
+            return;
+        }
+
+        vfs_.Delete(to);
+
+        if (vfs_.Rename(from, to, true))
+            return;
+
+        if (String path = Concat(to, "/"); PlatformFolderExists(Concat(root_, path)))
+        {
+            // Renamed folders are rebuilt, which only touches the files inside of them
+            vfs_.DeleteFolder(Concat(from, "/"));
+            vfs_.DeleteFolder(path);
+
+            AddFolder(path);
+        }
+        else
+        {
+            AddEntry(to);
+        }
+    }
+
+    void LooseFileDevice::OnOverflow()
+    {
+        rescan_ = true;
+    }
+
+    void LooseFileDevice::AddEntry(StringView name)
+    {
+        Rc<Stream> input = PlatformOpenFile(Concat(root_, name), true);
+
+        if (input == nullptr)
+            return;
+
+        vfs_.AddFile<LooseFileNode>(name, static_cast<u64>(input->Size()));
+    }
+
+    void LooseFileDevice::AddFolder(StringView path)
+    {
+        String full_path = Concat(root_, path);
+
+        Ptr<FindFileHandle> find = PlatformFindFiles(full_path);
+
+        if (find == nullptr)
+            return;
+
+        String name;
+
+        for (FolderEntry& entry : *find)
+        {
+            name = Concat(path, entry.Name);
+
+            if (entry.IsFolder)
+            {
+                name.push_back('/');
+
+                AddFolder(name);
+            }
+            else
+            {
+                vfs_.AddFile<LooseFileNode>(name, entry.Size);
+            }
+        }
+    }
+} // namespace Iridium
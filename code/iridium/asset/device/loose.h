@@ -0,0 +1,46 @@
+#pragma once
+
+#include "asset/device/virtual.h"
+#include "asset/filewatcher.h"
+
+namespace Iridium
+{
+    // Mirrors a folder of loose files, for mounting over archives with MultiFileDevice
+    // Changes on disk are applied incrementally, rather than rescanning the whole folder
+    class LooseFileDevice final
+        : public VirtualFileDevice
+        , private FileSystemListener
+    {
+    public:
+        LooseFileDevice(String root);
+
+        // Scans the whole folder, and starts watching it for changes
+        bool RefreshFileList();
+
+        // Waits up to timeout milliseconds for changes, and applies them
+        // Returns whether anything changed
+        bool Refresh(u32 timeout = 0);
+
+        const String& GetRoot() const
+        {
+            return root_;
+        }
+
+    private:
+        void OnAdded(StringView name) override;
+        void OnRemoved(StringView name) override;
+        void OnModified(StringView name) override;
+        void OnRenamed(StringView from, StringView to) override;
+        void OnOverflow() override;
+
+        void AddEntry(StringView name);
+        void AddFolder(StringView path);
+
+        String root_;
+
+        Ptr<FileSystemWatcher> watcher_;
+
+        // Set when events could not be applied, and everything needs to be rescanned
+        bool rescan_ {false};
+    };
+} // namespace Iridium
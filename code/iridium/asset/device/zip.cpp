@@ -5,7 +5,7 @@
 #include "asset/stream/buffered.h"
 #include "asset/stream/decode.h"
 #include "asset/stream/partial.h"
-#include "asset/transform/deflate.h"
+#include "asset/transform.h"
 #include "core/bits.h"
 
 namespace Iridium::Zip
@@ -110,6 +110,8 @@ namespace Iridium
     ZipArchive::ZipArchive(Rc<Stream> input)
         : input_(std::move(input))
     {
+        vfs_.FileContext = this;
+
         RefreshFileList();
     }
 
@@ -269,16 +271,18 @@ namespace Iridium
                 Entry.Offset = Entry.HeaderOffset + sizeof(record) + record.FileNameLength + record.ExtraFieldLength;
             }
 
-            switch (Entry.Compression)
-            {
-                case CompressorId::Stored: return MakeRc<PartialStream>(Entry.Offset, Entry.Size, input);
+            input->Advise(Entry.Offset, Entry.RawSize, AccessPattern::WillNeed);
 
-                case CompressorId::Deflate:
-                    return MakeRc<DecodeStream>(MakeRc<PartialStream>(Entry.Offset, Entry.RawSize, input),
-                        MakeUnique<InflateTransform>(), Entry.Size);
+            if (Entry.Compression == CompressorId::Stored)
+                return MakeRc<PartialStream>(Entry.Offset, Entry.Size, input);
 
-                default: return nullptr;
-            }
+            Ptr<BinaryTransform> transform = CreateDecodeTransform(Entry.Compression, Entry.Size);
+
+            if (transform == nullptr)
+                return nullptr;
+
+            return MakeRc<DecodeStream>(
+                MakeRc<PartialStream>(Entry.Offset, Entry.RawSize, input), std::move(transform), Entry.Size);
         }
 
         bool Stat(void* /*ctx*/, FolderEntry& entry) override
@@ -289,12 +293,25 @@ namespace Iridium
         }
     };
 
+    static CompressorId GetZipCompressorId(u16 method)
+    {
+        switch (method)
+        {
+            case 0: return CompressorId::Stored;
+            case 8: return CompressorId::Deflate;
+            case 93: return CompressorId::Zstd;
+            default: return CompressorId::Invalid;
+        }
+    }
+
     bool ZipArchive::ParseCentralDirectory()
     {
         if (!FindCentralDirectory())
             return false;
 
-        BufferedStream stream(input_);
+        // The central directory is one long run of small records, so keep the next chunks in flight while parsing
+        BufferedStream stream(input_, 0x10000);
+        stream.SetReadAhead(2);
 
         if (!stream.TrySeek(cd_offset_))
             return false;
@@ -323,14 +340,15 @@ namespace Iridium
                 if (!stream.TryRead(entry_name.data(), entry_name.size()))
                     break;
 
+                CompressorId const compression = GetZipCompressorId(entry.Compression);
+
                 if ((entry_name.back() != '/') && (entry_name.back() != '\\') &&
-                    (entry.Compression == 0 || entry.Compression == 8))
+                    (compression != CompressorId::Invalid))
                 {
                     PathNormalizeSlash(entry_name);
 
                     vfs_.AddFile<ZipFileNode>(entry_name,
-                        ZipFileEntry {-1, entry.UncompressedSize, entry.CompressedSize, entry.HeaderOffset,
-                            (entry.Compression == 8) ? CompressorId::Deflate : CompressorId::Stored});
+                        ZipFileEntry {-1, entry.UncompressedSize, entry.CompressedSize, entry.HeaderOffset, compression});
                 }
             }
 
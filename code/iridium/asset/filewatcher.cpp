@@ -1,5 +1,3 @@
-#pragma once
-
 #include "filewatcher.h"
 
 namespace Iridium
@@ -15,4 +13,119 @@ namespace Iridium
 
     void FileSystemListener::OnRenamed(StringView, StringView)
     {}
+
+    void FileSystemListener::OnOverflow()
+    {}
+
+    void FileSystemEventBatch::OnAdded(StringView name)
+    {
+        AddEvent(EventType::Added, name);
+    }
+
+    void FileSystemEventBatch::OnRemoved(StringView name)
+    {
+        AddEvent(EventType::Removed, name);
+    }
+
+    void FileSystemEventBatch::OnModified(StringView name)
+    {
+        AddEvent(EventType::Modified, name);
+    }
+
+    void FileSystemEventBatch::OnRenamed(StringView from, StringView to)
+    {
+        latest_.erase(String(from));
+        latest_.erase(String(to));
+
+        events_.push_back({EventType::Renamed, String(from), String(to)});
+    }
+
+    void FileSystemEventBatch::OnOverflow()
+    {
+        // Everything collected so far is about to be rebuilt anyway
+        events_.clear();
+        latest_.clear();
+
+        overflow_ = true;
+    }
+
+    void FileSystemEventBatch::Flush(FileSystemListener& listener)
+    {
+        if (overflow_)
+            listener.OnOverflow();
+
+        for (const Event& event : events_)
+        {
+            switch (event.Type)
+            {
+                case EventType::None: break;
+                case EventType::Added: listener.OnAdded(event.Name); break;
+                case EventType::Removed: listener.OnRemoved(event.Name); break;
+                case EventType::Modified: listener.OnModified(event.Name); break;
+                case EventType::Renamed: listener.OnRenamed(event.Name, event.NewName); break;
+            }
+        }
+
+        events_.clear();
+        latest_.clear();
+
+        overflow_ = false;
+    }
+
+    bool FileSystemEventBatch::Empty() const
+    {
+        return !overflow_ && events_.empty();
+    }
+
+    void FileSystemEventBatch::AddEvent(EventType type, StringView name)
+    {
+        auto [find, inserted] = latest_.try_emplace(String(name), events_.size());
+
+        if (!inserted)
+        {
+            Event& latest = events_[find->second];
+
+            switch (latest.Type)
+            {
+                case EventType::Added:
+                    // Added + Removed = Nothing
+                    if (type == EventType::Removed)
+                    {
+                        latest.Type = EventType::None;
+                        latest_.erase(find);
+                    }
+
+                    // Added + Added/Modified = Added
+                    return;
+
+                case EventType::Modified:
+                    // Modified + Removed = Removed
+                    if (type == EventType::Removed)
+                        latest.Type = EventType::Removed;
+
+                    // Modified + Added/Modified = Modified
+                    if (type != EventType::Added)
+                        return;
+
+                    break;
+
+                case EventType::Removed:
+                    // Removed + Added = Modified
+                    if (type == EventType::Added)
+                    {
+                        latest.Type = EventType::Modified;
+
+                        return;
+                    }
+
+                    break;
+
+                default: break;
+            }
+
+            find->second = events_.size();
+        }
+
+        events_.push_back({type, String(name), {}});
+    }
 } // namespace Iridium
@@ -11,6 +11,54 @@ namespace Iridium
         virtual void OnRemoved(StringView name);
         virtual void OnModified(StringView name);
         virtual void OnRenamed(StringView from, StringView to);
+
+        // Called when events were lost, e.g. because too many arrived at once
+        // Anything derived from earlier events should be rebuilt from scratch
+        virtual void OnOverflow();
+    };
+
+    // Collects file system events, merging redundant events for the same file
+    // Added followed by Modified becomes Added, Added followed by Removed cancels out, and so on
+    class FileSystemEventBatch final : public FileSystemListener
+    {
+    public:
+        void OnAdded(StringView name) override;
+        void OnRemoved(StringView name) override;
+        void OnModified(StringView name) override;
+        void OnRenamed(StringView from, StringView to) override;
+        void OnOverflow() override;
+
+        // Delivers the collected events in order, and clears the batch
+        void Flush(FileSystemListener& listener);
+
+        bool Empty() const;
+
+    private:
+        enum class EventType : u8
+        {
+            None,
+            Added,
+            Removed,
+            Modified,
+            Renamed,
+        };
+
+        struct Event
+        {
+            EventType Type {EventType::None};
+            String Name;
+            String NewName;
+        };
+
+        void AddEvent(EventType type, StringView name);
+
+        Vec<Event> events_;
+
+        // Index of the most recent event for each name, which later events can be merged into
+        // Renames are never merged, so they clear the entries of both names
+        HashMap<String, usize> latest_;
+
+        bool overflow_ {false};
     };
 
     namespace NotifyFilter
@@ -31,11 +79,15 @@ namespace Iridium
 
     using NotifyFilter::NotifyFilters;
 
+    // Watches a folder and all of its subfolders for changes
+    // Event names are relative to the watched folder
     class FileSystemWatcher
     {
     public:
         virtual ~FileSystemWatcher() = default;
 
+        // Waits up to timeout milliseconds for changes, and delivers them to the listener
+        // Returns whether any changes were delivered
         virtual bool Poll(FileSystemListener& listener, u32 timeout) = 0;
     };
 } // namespace Iridium
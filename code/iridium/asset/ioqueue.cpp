@@ -0,0 +1,64 @@
+#include "ioqueue.h"
+
+namespace Iridium
+{
+    IoQueue::~IoQueue()
+    {
+        ReapCompleted();
+    }
+
+    bool IoQueue::QueueNativeRead(usize, void*, usize, u64, IoCompletion, void*)
+    {
+        return false;
+    }
+
+    void IoQueue::Complete(IoCompletion completion, void* context, usize result)
+    {
+        completed_.push_back({completion, context, result});
+    }
+
+    usize IoQueue::Submit()
+    {
+        return 0;
+    }
+
+    usize IoQueue::Reap(usize)
+    {
+        return ReapCompleted();
+    }
+
+    usize IoQueue::Pending() const
+    {
+        return completed_.size();
+    }
+
+    void IoQueue::Drain()
+    {
+        while (Pending())
+            Reap(1);
+    }
+
+    bool IoQueue::IsAsync() const
+    {
+        return false;
+    }
+
+    usize IoQueue::ReapCompleted()
+    {
+        usize total = 0;
+
+        // Completions may submit further reads, so keep going until nothing is left
+        while (!completed_.empty())
+        {
+            Vec<CompletedRead> completed;
+            completed.swap(completed_);
+
+            for (const CompletedRead& read : completed)
+                read.Completion(read.Context, read.Result);
+
+            total += completed.size();
+        }
+
+        return total;
+    }
+} // namespace Iridium
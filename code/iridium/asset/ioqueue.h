@@ -0,0 +1,56 @@
+#pragma once
+
+namespace Iridium
+{
+    // Invoked once an asynchronous read has finished
+    // result is the number of bytes read
+    using IoCompletion = void (*)(void* context, usize result);
+
+    // A queue of asynchronous reads, created through PlatformCreateIoQueue
+    // The base implementation has no native support, and completes reads as soon as they are submitted
+    // Completions are only invoked from Reap, or while queueing a read when the queue is full
+    // Any pending reads are completed before the queue is destroyed
+    class IoQueue
+    {
+    public:
+        virtual ~IoQueue();
+
+        // Queues a read of len bytes at the specified offset from a native file handle (file descriptor or HANDLE)
+        // Returns false if native reads are not supported, in which case the caller should read synchronously
+        virtual bool QueueNativeRead(
+            usize handle, void* ptr, usize len, u64 offset, IoCompletion completion, void* context);
+
+        // Records a read which has already finished, to be completed by the next call to Reap
+        void Complete(IoCompletion completion, void* context, usize result);
+
+        // Hands all queued reads to the kernel
+        // Returns the number of reads submitted
+        virtual usize Submit();
+
+        // Submits all queued reads, and waits for at least min_complete reads to finish
+        // Returns the number of completions invoked
+        virtual usize Reap(usize min_complete);
+
+        // Retrieves the number of reads which have not yet been completed
+        virtual usize Pending() const;
+
+        // Waits for all pending reads to be completed
+        void Drain();
+
+        // Whether reads can be performed natively, rather than being completed as soon as they are submitted
+        virtual bool IsAsync() const;
+
+    protected:
+        usize ReapCompleted();
+
+    private:
+        struct CompletedRead
+        {
+            IoCompletion Completion {nullptr};
+            void* Context {nullptr};
+            usize Result {0};
+        };
+
+        Vec<CompletedRead> completed_;
+    };
+} // namespace Iridium
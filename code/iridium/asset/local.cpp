@@ -3,14 +3,27 @@
 #include "findhandle.h"
 #include "platform_io.h"
 #include "stream.h"
+#include "stream/mapped.h"
 
 namespace Iridium
 {
     Rc<Stream> LocalFileDevice::Open(StringView path, bool read_only)
     {
+        // Mapping can fail (such as for pipes, or running out of address space), so fall back to a regular file
+        if (read_only && map_files_)
+        {
+            if (Rc<MappedFileStream> mapped = PlatformMapFile(path))
+                return mapped;
+        }
+
         return PlatformOpenFile(path, read_only);
     }
 
+    void LocalFileDevice::SetMapFiles(bool map_files)
+    {
+        map_files_ = map_files;
+    }
+
     Rc<Stream> LocalFileDevice::Create(StringView path, bool write_only, bool truncate)
     {
         return PlatformCreateFile(path, write_only, truncate);
@@ -16,9 +16,17 @@ namespace Iridium
 
         bool Delete(StringView path) override;
 
+        // Opens read-only files by mapping them into memory, so archives read their entries straight out of the view
+        // Disabled by default, as a mapped file which is truncated faults instead of reading short,
+        // and large mappings use up the address space of 32-bit processes
+        // Intended to be set once at startup
+        void SetMapFiles(bool map_files);
+
         friend const Rc<LocalFileDevice>& LocalFiles();
 
     private:
+        bool map_files_ {false};
+
         static StaticRc<LocalFileDevice> s_LocalFiles;
     };
 
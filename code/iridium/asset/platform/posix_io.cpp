@@ -0,0 +1,1418 @@
+#include "asset/filewatcher.h"
+#include "asset/findhandle.h"
+#include "asset/ioqueue.h"
+#include "asset/platform_io.h"
+#include "asset/stream.h"
+#include "asset/stream/mapped.h"
+
+#include "core/meta/metadefine.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__NR_io_uring_setup)
+#    include <linux/io_uring.h>
+#    define IR_POSIX_IO_URING
+#endif
+
+#ifdef __linux__
+#    include <poll.h>
+#    include <sys/inotify.h>
+#    define IR_POSIX_INOTIFY
+#endif
+
+#ifdef __linux__
+#    include <sys/sendfile.h>
+#    define IR_POSIX_COPY_FILE_RANGE
+#endif
+
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+namespace Iridium
+{
+    class PosixFileStream final : public Stream
+    {
+    public:
+        PosixFileStream(int fd);
+        ~PosixFileStream() override;
+
+        i64 Seek(i64 offset, SeekWhence whence) override;
+
+        i64 Tell() override;
+        i64 Size() override;
+
+        usize Read(void* ptr, usize len) override;
+        usize Write(const void* ptr, usize len) override;
+
+        usize ReadBulk(void* ptr, usize len, u64 offset) override;
+        usize WriteBulk(const void* ptr, usize len, u64 offset) override;
+
+        usize ReadBulkV(IoRange* ranges, usize count) override;
+
+        void SubmitReadBulk(
+            IoQueue& queue, void* ptr, usize len, u64 offset, IoCompletion completion, void* context) override;
+
+        void Advise(u64 offset, u64 len, AccessPattern pattern) override;
+
+        bool Flush() override;
+
+        i64 SetSize(u64 length) override;
+
+        u64 CopyTo(Stream& output) override;
+        u64 CopyBulkTo(Stream& output, u64 offset, u64 len) override;
+
+        bool IsBulkSync() const override;
+        bool IsFullSync() const override;
+
+        bool CanReadAsync() const override;
+
+        VIRTUAL_META_DECLARE;
+
+    private:
+        int fd_ {-1};
+    };
+
+    class PosixMappedFileStream final : public MappedFileStream
+    {
+    public:
+        PosixMappedFileStream(const u8* data, u64 size);
+        ~PosixMappedFileStream() override;
+
+        void Advise(u64 offset, u64 len, AccessPattern pattern) override;
+    };
+
+    class PosixFindFileHandle final : public FindFileHandle
+    {
+    public:
+        PosixFindFileHandle(DIR* handle);
+        ~PosixFindFileHandle() override;
+
+        bool Next(FolderEntry& entry) override;
+
+    private:
+        DIR* handle_ {nullptr};
+    };
+
+#ifdef IR_POSIX_IO_URING
+    // Talks to io_uring directly, there is no need to pull in liburing for plain reads
+    class PosixUringQueue final : public IoQueue
+    {
+    public:
+        ~PosixUringQueue() override;
+
+        bool Init(u32 depth);
+
+        bool QueueNativeRead(
+            usize handle, void* ptr, usize len, u64 offset, IoCompletion completion, void* context) override;
+
+        usize Submit() override;
+        usize Reap(usize min_complete) override;
+
+        usize Pending() const override;
+
+        bool IsAsync() const override;
+
+    private:
+        struct Request
+        {
+            int Fd {-1};
+            u8* Buffer {nullptr};
+            usize Length {0};
+            u64 Offset {0};
+            usize Done {0};
+
+            IoCompletion Completion {nullptr};
+            void* Context {nullptr};
+
+            // Read through IORING_OP_READV, as IORING_OP_READ needs Linux 5.6
+            iovec Vec {};
+        };
+
+        bool PushRead(u32 index);
+        int Enter(u32 min_complete, u32 flags);
+        usize HandleCompletions();
+
+        int fd_ {-1};
+
+        void* sq_ring_ {nullptr};
+        usize sq_ring_size_ {0};
+
+        void* cq_ring_ {nullptr};
+        usize cq_ring_size_ {0};
+
+        io_uring_sqe* sqes_ {nullptr};
+        usize sqes_size_ {0};
+
+        u32* sq_head_ {nullptr};
+        u32* sq_tail_ {nullptr};
+        u32* sq_array_ {nullptr};
+        u32 sq_mask_ {0};
+        u32 sq_entries_ {0};
+
+        u32* cq_head_ {nullptr};
+        u32* cq_tail_ {nullptr};
+        io_uring_cqe* cqes_ {nullptr};
+        u32 cq_mask_ {0};
+
+        // Reads added to the submission ring, but not yet consumed by the kernel
+        u32 unsubmitted_ {0};
+
+        // One slot per possible completion, so the completion ring can never overflow
+        Vec<Request> requests_;
+        Vec<u32> free_;
+    };
+#endif
+
+#ifdef IR_POSIX_INOTIFY
+    class PosixFileSystemWatcher final : public FileSystemWatcher
+    {
+    public:
+        PosixFileSystemWatcher(int fd, String root, NotifyFilters filter);
+        ~PosixFileSystemWatcher() override;
+
+        bool Poll(FileSystemListener& listener, u32 timeout) override;
+
+    private:
+        void AddWatches(const String& path, bool report);
+        void RemoveWatches(const String& path);
+        void RenameWatches(const String& from, const String& to);
+
+        void ReadEvents();
+        void HandleEvent(const inotify_event& event);
+        void FlushPendingMove();
+
+        int fd_ {-1};
+        u32 mask_ {0};
+        NotifyFilters filter_ {};
+
+        // Always ends with a slash
+        String root_;
+
+        // Watch descriptor to folder path, relative to root_ and ending with a slash (except for root_ itself)
+        HashMap<int, String> watches_;
+
+        FileSystemEventBatch batch_;
+
+        // IN_MOVED_FROM waiting for a matching IN_MOVED_TO
+        u32 move_cookie_ {0};
+        bool move_is_folder_ {false};
+        String move_from_;
+    };
+#endif
+
+    static usize PosixToNativePath(StringView input, char* buffer, usize buffer_len)
+    {
+        if (buffer_len == 0)
+            return 0;
+
+        usize converted = input.size();
+
+        if ((converted >= buffer_len) || (input.find('\0') != StringView::npos) ||
+            (input.find("../"_sv) != StringView::npos))
+            converted = 0;
+
+        std::memcpy(buffer, input.data(), converted);
+        buffer[converted] = '\0';
+
+        return converted;
+    }
+
+    PosixFileStream::PosixFileStream(int fd)
+        : fd_(fd)
+    {}
+
+    PosixFileStream::~PosixFileStream()
+    {
+        if (fd_ != -1)
+            close(fd_);
+    }
+
+    i64 PosixFileStream::Seek(i64 offset, SeekWhence whence)
+    {
+        int method = SEEK_SET;
+
+        switch (whence)
+        {
+            case SeekWhence::Set: method = SEEK_SET; break;
+            case SeekWhence::Cur: method = SEEK_CUR; break;
+            case SeekWhence::End: method = SEEK_END; break;
+        }
+
+        return lseek(fd_, static_cast<off_t>(offset), method);
+    }
+
+    i64 PosixFileStream::Tell()
+    {
+        return lseek(fd_, 0, SEEK_CUR);
+    }
+
+    i64 PosixFileStream::Size()
+    {
+        struct stat info;
+
+        return (fstat(fd_, &info) == 0) ? info.st_size : -1;
+    }
+
+    // read/write/pread/pwrite may transfer less than requested (signals, or more than 0x7FFFF000 bytes on Linux)
+    // Keep going until the request is satisfied, or we hit EOF or an error
+    template <typename F>
+    static IR_FORCEINLINE usize PosixTransferAll(usize len, F transfer)
+    {
+        usize total = 0;
+
+        while (total < len)
+        {
+            ssize_t const result = transfer(total, len - total);
+
+            if (result > 0)
+                total += static_cast<usize>(result);
+            else if ((result == 0) || (errno != EINTR))
+                break;
+        }
+
+        return total;
+    }
+
+    usize PosixFileStream::Read(void* ptr, usize len)
+    {
+        return PosixTransferAll(
+            len, [&](usize done, usize todo) { return read(fd_, static_cast<u8*>(ptr) + done, todo); });
+    }
+
+    usize PosixFileStream::Write(const void* ptr, usize len)
+    {
+        return PosixTransferAll(
+            len, [&](usize done, usize todo) { return write(fd_, static_cast<const u8*>(ptr) + done, todo); });
+    }
+
+    usize PosixFileStream::ReadBulk(void* ptr, usize len, u64 offset)
+    {
+        // pread never touches the file position, so concurrent bulk reads need no locking
+        return PosixTransferAll(len, [&](usize done, usize todo) {
+            return pread(fd_, static_cast<u8*>(ptr) + done, todo, static_cast<off_t>(offset + done));
+        });
+    }
+
+    usize PosixFileStream::WriteBulk(const void* ptr, usize len, u64 offset)
+    {
+        return PosixTransferAll(len, [&](usize done, usize todo) {
+            return pwrite(fd_, static_cast<const u8*>(ptr) + done, todo, static_cast<off_t>(offset + done));
+        });
+    }
+
+    usize PosixFileStream::ReadBulkV(IoRange* ranges, usize count)
+    {
+        // Gaps up to this size are read into a scratch buffer, rather than splitting the read
+        constexpr usize MaxGap = 16 * 1024;
+
+        // Comfortably below IOV_MAX on every platform
+        constexpr usize MaxVecs = 256;
+
+        Vec<IoRange*> sorted(count);
+
+        for (usize i = 0; i < count; ++i)
+            sorted[i] = &ranges[i];
+
+        std::sort(sorted.begin(), sorted.end(), [](IoRange* lhs, IoRange* rhs) { return lhs->Offset < rhs->Offset; });
+
+        u8 gap[MaxGap];
+        iovec vecs[MaxVecs];
+
+        usize completed = 0;
+
+        for (usize i = 0; i < count;)
+        {
+            u64 const start = sorted[i]->Offset;
+            u64 end = start;
+
+            usize num_vecs = 0;
+            usize j = i;
+
+            // Merge ranges until one overlaps, is too far away, or we run out of vectors
+            for (; j < count; ++j)
+            {
+                const IoRange& range = *sorted[j];
+
+                if ((range.Offset < end) || (range.Offset - end > MaxGap))
+                    break;
+
+                if (num_vecs + (range.Offset != end) + 1 > MaxVecs)
+                    break;
+
+                if (range.Offset != end)
+                    vecs[num_vecs++] = {gap, static_cast<usize>(range.Offset - end)};
+
+                vecs[num_vecs++] = {range.Data, range.Length};
+
+                end = range.Offset + range.Length;
+            }
+
+            ssize_t result = 0;
+
+            do
+            {
+                result = preadv(fd_, vecs, static_cast<int>(num_vecs), static_cast<off_t>(start));
+            } while ((result < 0) && (errno == EINTR));
+
+            u64 const done = (result > 0) ? static_cast<u64>(result) : 0;
+
+            for (; i < j; ++i)
+            {
+                IoRange& range = *sorted[i];
+
+                u64 const skip = range.Offset - start;
+
+                range.Result = (done > skip) ? static_cast<usize>(std::min<u64>(done - skip, range.Length)) : 0;
+
+                // Finish off anything the merged read came up short on (EOF, or a partial read)
+                if (range.Result < range.Length)
+                {
+                    range.Result += ReadBulk(static_cast<u8*>(range.Data) + range.Result, range.Length - range.Result,
+                        range.Offset + range.Result);
+                }
+
+                if (range.Result == range.Length)
+                    ++completed;
+            }
+        }
+
+        return completed;
+    }
+
+    void PosixFileStream::SubmitReadBulk(
+        IoQueue& queue, void* ptr, usize len, u64 offset, IoCompletion completion, void* context)
+    {
+        if (!queue.QueueNativeRead(static_cast<usize>(fd_), ptr, len, offset, completion, context))
+            queue.Complete(completion, context, ReadBulk(ptr, len, offset));
+    }
+
+    void PosixFileStream::Advise(u64 offset, u64 len, AccessPattern pattern)
+    {
+#ifdef POSIX_FADV_NORMAL
+        int advice = POSIX_FADV_NORMAL;
+
+        switch (pattern)
+        {
+            case AccessPattern::Normal: advice = POSIX_FADV_NORMAL; break;
+            case AccessPattern::Sequential: advice = POSIX_FADV_SEQUENTIAL; break;
+            case AccessPattern::Random: advice = POSIX_FADV_RANDOM; break;
+            case AccessPattern::WillNeed: advice = POSIX_FADV_WILLNEED; break;
+            case AccessPattern::DontNeed: advice = POSIX_FADV_DONTNEED; break;
+        }
+
+        // WILLNEED starts asynchronous readahead, unlike readahead(2) which blocks until the data has been read
+        posix_fadvise(fd_, static_cast<off_t>(offset), static_cast<off_t>(len), advice);
+#else
+        (void) offset;
+        (void) len;
+        (void) pattern;
+#endif
+    }
+
+    bool PosixFileStream::Flush()
+    {
+        return fsync(fd_) == 0;
+    }
+
+    i64 PosixFileStream::SetSize(u64 length)
+    {
+        return (ftruncate(fd_, static_cast<off_t>(length)) == 0) ? static_cast<i64>(length) : -1;
+    }
+
+    u64 PosixFileStream::CopyTo(Stream& output)
+    {
+        struct stat info;
+
+        i64 const here = Tell();
+
+        // Pipes and devices have no meaningful size, so just read until they run dry
+        if ((here < 0) || (fstat(fd_, &info) != 0) || !S_ISREG(info.st_mode))
+            return Stream::CopyTo(output);
+
+        if (here >= info.st_size)
+            return 0;
+
+        u64 const result = CopyBulkTo(output, here, info.st_size - here);
+
+        lseek(fd_, static_cast<off_t>(here + result), SEEK_SET);
+
+        return result;
+    }
+
+    u64 PosixFileStream::CopyBulkTo(Stream& output, u64 offset, u64 len)
+    {
+        u64 total = 0;
+
+#ifdef IR_POSIX_COPY_FILE_RANGE
+        if (output.IsA<PosixFileStream>())
+        {
+            int const out_fd = static_cast<PosixFileStream&>(output).fd_;
+
+            // copy_file_range keeps the data in the kernel, and shares extents (reflinks) where the file system can
+            // It refuses some combinations (crossing file systems on older kernels, O_APPEND), which sendfile handles
+            bool copy_range = true;
+
+            while (total < len)
+            {
+                usize const todo = static_cast<usize>(std::min<u64>(len - total, 0x40000000));
+                off_t in_offset = static_cast<off_t>(offset + total);
+
+                ssize_t const result = copy_range ? copy_file_range(fd_, &in_offset, out_fd, nullptr, todo, 0)
+                                                  : sendfile(out_fd, fd_, &in_offset, todo);
+
+                if (result > 0)
+                    total += static_cast<u64>(result);
+                else if (result == 0)
+                    return total;
+                else if (errno == EINTR)
+                    continue;
+                else if (copy_range && (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP ||
+                                           errno == EBADF))
+                    copy_range = false;
+                else
+                    break;
+            }
+        }
+#endif
+
+        return total + Stream::CopyBulkTo(output, offset + total, len - total);
+    }
+
+    bool PosixFileStream::IsBulkSync() const
+    {
+        return true;
+    }
+
+    bool PosixFileStream::IsFullSync() const
+    {
+        return true;
+    }
+
+    bool PosixFileStream::CanReadAsync() const
+    {
+        return true;
+    }
+
+    VIRTUAL_META_DEFINE_CHILD("PosixFileStream", PosixFileStream, Stream)
+    {}
+
+#ifdef IR_POSIX_IO_URING
+    PosixUringQueue::~PosixUringQueue()
+    {
+        // The kernel may still be writing into the buffers of any pending reads
+        if (fd_ != -1)
+            Drain();
+
+        if (sqes_)
+            munmap(sqes_, sqes_size_);
+
+        if (cq_ring_ && cq_ring_ != sq_ring_)
+            munmap(cq_ring_, cq_ring_size_);
+
+        if (sq_ring_)
+            munmap(sq_ring_, sq_ring_size_);
+
+        if (fd_ != -1)
+            close(fd_);
+    }
+
+    bool PosixUringQueue::Init(u32 depth)
+    {
+        io_uring_params params {};
+
+        fd_ = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+
+        // Not supported by the kernel, or blocked by a sandbox
+        if (fd_ < 0)
+        {
+            fd_ = -1;
+
+            return false;
+        }
+
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(u32);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+
+        bool const single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+
+        if (single_mmap)
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+        sq_ring_ =
+            mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+
+        if (sq_ring_ == MAP_FAILED)
+        {
+            sq_ring_ = nullptr;
+
+            return false;
+        }
+
+        if (single_mmap)
+        {
+            cq_ring_ = sq_ring_;
+        }
+        else
+        {
+            cq_ring_ = mmap(
+                nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+
+            if (cq_ring_ == MAP_FAILED)
+            {
+                cq_ring_ = nullptr;
+
+                return false;
+            }
+        }
+
+        void* sqes =
+            mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+
+        if (sqes == MAP_FAILED)
+            return false;
+
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        u8* sq_ring = static_cast<u8*>(sq_ring_);
+        u8* cq_ring = static_cast<u8*>(cq_ring_);
+
+        sq_head_ = reinterpret_cast<u32*>(sq_ring + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<u32*>(sq_ring + params.sq_off.tail);
+        sq_array_ = reinterpret_cast<u32*>(sq_ring + params.sq_off.array);
+        sq_mask_ = *reinterpret_cast<u32*>(sq_ring + params.sq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+
+        cq_head_ = reinterpret_cast<u32*>(cq_ring + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<u32*>(cq_ring + params.cq_off.tail);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq_ring + params.cq_off.cqes);
+        cq_mask_ = *reinterpret_cast<u32*>(cq_ring + params.cq_off.ring_mask);
+
+        requests_.resize(params.cq_entries);
+        free_.reserve(params.cq_entries);
+
+        for (u32 i = params.cq_entries; i--;)
+            free_.push_back(i);
+
+        return true;
+    }
+
+    bool PosixUringQueue::QueueNativeRead(
+        usize handle, void* ptr, usize len, u64 offset, IoCompletion completion, void* context)
+    {
+        // Every slot is in flight, so wait for (and complete) at least one of them
+        if (free_.empty())
+            Reap(1);
+
+        if (free_.empty())
+            return false;
+
+        u32 const index = free_.back();
+        free_.pop_back();
+
+        requests_[index] = {static_cast<int>(handle), static_cast<u8*>(ptr), len, offset, 0, completion, context};
+
+        if (!PushRead(index))
+        {
+            free_.push_back(index);
+
+            return false;
+        }
+
+        return true;
+    }
+
+    usize PosixUringQueue::Submit()
+    {
+        if (unsubmitted_ == 0)
+            return 0;
+
+        int const result = Enter(0, 0);
+
+        return (result > 0) ? static_cast<usize>(result) : 0;
+    }
+
+    usize PosixUringQueue::Reap(usize min_complete)
+    {
+        usize total = ReapCompleted() + HandleCompletions();
+
+        while ((total < min_complete) && (requests_.size() != free_.size()))
+        {
+            if (Enter(1, IORING_ENTER_GETEVENTS) < 0)
+                break;
+
+            total += ReapCompleted() + HandleCompletions();
+        }
+
+        return total;
+    }
+
+    usize PosixUringQueue::Pending() const
+    {
+        return IoQueue::Pending() + (requests_.size() - free_.size());
+    }
+
+    bool PosixUringQueue::IsAsync() const
+    {
+        return true;
+    }
+
+    bool PosixUringQueue::PushRead(u32 index)
+    {
+        u32 const tail = *sq_tail_;
+
+        if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_)
+        {
+            Submit();
+
+            if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_)
+                return false;
+        }
+
+        Request& request = requests_[index];
+
+        // Reads are capped at 0x7FFFF000 bytes, any remainder is resubmitted after the first part completes
+        request.Vec.iov_base = request.Buffer + request.Done;
+        request.Vec.iov_len = std::min<usize>(request.Length - request.Done, 0x7FFFF000);
+
+        io_uring_sqe& sqe = sqes_[tail & sq_mask_];
+        std::memset(&sqe, 0, sizeof(sqe));
+
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = request.Fd;
+        sqe.addr = reinterpret_cast<u64>(&request.Vec);
+        sqe.len = 1;
+        sqe.off = request.Offset + request.Done;
+        sqe.user_data = index;
+
+        sq_array_[tail & sq_mask_] = tail & sq_mask_;
+
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+        ++unsubmitted_;
+
+        return true;
+    }
+
+    int PosixUringQueue::Enter(u32 min_complete, u32 flags)
+    {
+        int result = 0;
+
+        do
+        {
+            result = static_cast<int>(syscall(__NR_io_uring_enter, fd_, unsubmitted_, min_complete, flags, nullptr, 0));
+        } while ((result < 0) && (errno == EINTR));
+
+        if (result > 0)
+            unsubmitted_ -= std::min<u32>(unsubmitted_, static_cast<u32>(result));
+
+        return result;
+    }
+
+    usize PosixUringQueue::HandleCompletions()
+    {
+        usize total = 0;
+
+        for (u32 head = *cq_head_; head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE); head = *cq_head_)
+        {
+            io_uring_cqe const cqe = cqes_[head & cq_mask_];
+
+            // Release the entry before running any completions, they may submit (and reap) further reads
+            __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+
+            u32 const index = static_cast<u32>(cqe.user_data);
+            Request& request = requests_[index];
+
+            if (cqe.res > 0)
+            {
+                request.Done += static_cast<usize>(cqe.res);
+            }
+            else if ((cqe.res == -EINVAL) || (cqe.res == -EOPNOTSUPP))
+            {
+                // The kernel (or file system) doesn't support this read, so finish it synchronously instead
+                request.Done += PosixTransferAll(request.Length - request.Done, [&](usize done, usize todo) {
+                    return pread(request.Fd, request.Buffer + request.Done + done, todo,
+                        static_cast<off_t>(request.Offset + request.Done + done));
+                });
+            }
+
+            // Match PosixTransferAll, keep going until the read is satisfied, or we hit EOF or an error
+            bool const retry = (cqe.res == -EINTR) || (cqe.res == -EAGAIN) ||
+                ((cqe.res > 0) && (request.Done < request.Length));
+
+            if (retry && PushRead(index))
+                continue;
+
+            IoCompletion const completion = request.Completion;
+            void* const context = request.Context;
+            usize const result = request.Done;
+
+            free_.push_back(index);
+
+            completion(context, result);
+
+            ++total;
+        }
+
+        return total;
+    }
+#endif
+
+#ifdef IR_POSIX_INOTIFY
+    // How long the file system needs to stay quiet before a batch of events is delivered
+    static constexpr int PosixWatchDebounceTime = 50;
+
+    // Upper bound on how many times the debounce can be extended, so constant activity still delivers events
+    static constexpr usize PosixWatchDebounceLimit = 20;
+
+    PosixFileSystemWatcher::PosixFileSystemWatcher(int fd, String root, NotifyFilters filter)
+        : fd_(fd)
+        , filter_(filter)
+        , root_(std::move(root))
+    {
+        // Folder events are always needed to keep track of subfolders
+        mask_ = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR | IN_EXCL_UNLINK;
+
+        if (filter & NotifyFilter::Attributes)
+            mask_ |= IN_ATTRIB;
+
+        if (filter & (NotifyFilter::Size | NotifyFilter::LastWrite))
+            mask_ |= IN_MODIFY | IN_CLOSE_WRITE;
+
+        if (filter & NotifyFilter::LastAccess)
+            mask_ |= IN_ACCESS;
+
+        AddWatches({}, false);
+    }
+
+    PosixFileSystemWatcher::~PosixFileSystemWatcher()
+    {
+        // Closing the descriptor removes all watches
+        close(fd_);
+    }
+
+    bool PosixFileSystemWatcher::Poll(FileSystemListener& listener, u32 timeout)
+    {
+        pollfd events {fd_, POLLIN, 0};
+
+        if (poll(&events, 1, (timeout > INT_MAX) ? -1 : static_cast<int>(timeout)) <= 0)
+            return false;
+
+        // Keep reading until things quieten down, so a burst of writes becomes a single batch
+        for (usize i = 0; i < PosixWatchDebounceLimit; ++i)
+        {
+            ReadEvents();
+
+            if (poll(&events, 1, PosixWatchDebounceTime) <= 0)
+                break;
+        }
+
+        FlushPendingMove();
+
+        if (batch_.Empty())
+            return false;
+
+        batch_.Flush(listener);
+
+        return true;
+    }
+
+    void PosixFileSystemWatcher::AddWatches(const String& path, bool report)
+    {
+        String full_path = root_ + path;
+
+        // Adding a watch to a folder which is already watched returns the existing descriptor
+        int wd = inotify_add_watch(fd_, full_path.c_str(), mask_);
+
+        if (wd == -1)
+            return;
+
+        watches_[wd] = path;
+
+        Ptr<FindFileHandle> find = PlatformFindFiles(full_path);
+
+        if (find == nullptr)
+            return;
+
+        // Anything created before the watch was added has no events, so report it now
+        for (FolderEntry& entry : *find)
+        {
+            String name = path + entry.Name;
+
+            if (entry.IsFolder)
+            {
+                if (report && (filter_ & NotifyFilter::FolderName))
+                    batch_.OnAdded(name);
+
+                AddWatches(name + "/", report);
+            }
+            else if (report && (filter_ & NotifyFilter::FileName))
+            {
+                batch_.OnAdded(name);
+            }
+        }
+    }
+
+    void PosixFileSystemWatcher::RemoveWatches(const String& path)
+    {
+        for (auto i = watches_.begin(); i != watches_.end();)
+        {
+            if (StartsWith(i->second, path))
+            {
+                inotify_rm_watch(fd_, i->first);
+                i = watches_.erase(i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    void PosixFileSystemWatcher::RenameWatches(const String& from, const String& to)
+    {
+        for (auto& [wd, path] : watches_)
+        {
+            if (StartsWith(path, from))
+                path.replace(0, from.size(), to);
+        }
+    }
+
+    void PosixFileSystemWatcher::ReadEvents()
+    {
+        alignas(inotify_event) char buffer[16 * 1024];
+
+        while (true)
+        {
+            ssize_t const length = read(fd_, buffer, sizeof(buffer));
+
+            if (length <= 0)
+                break;
+
+            for (ssize_t i = 0; i < length;)
+            {
+                const inotify_event& event = *reinterpret_cast<const inotify_event*>(buffer + i);
+
+                HandleEvent(event);
+
+                i += sizeof(inotify_event) + event.len;
+            }
+        }
+    }
+
+    void PosixFileSystemWatcher::HandleEvent(const inotify_event& event)
+    {
+        if (event.mask & IN_Q_OVERFLOW)
+        {
+            // Events were lost, so any folders created in the meantime may not be watched
+            move_cookie_ = 0;
+
+            RemoveWatches({});
+            AddWatches({}, false);
+
+            batch_.OnOverflow();
+
+            return;
+        }
+
+        auto find = watches_.find(event.wd);
+
+        if (find == watches_.end())
+            return;
+
+        if (event.mask & IN_IGNORED)
+        {
+            watches_.erase(find);
+
+            return;
+        }
+
+        String name = find->second;
+
+        // The name is null padded
+        if (event.len)
+            name += event.name;
+
+        bool const is_folder = event.mask & IN_ISDIR;
+        bool const report = filter_ & (is_folder ? NotifyFilter::FolderName : NotifyFilter::FileName);
+
+        if (event.mask & IN_MOVED_FROM)
+        {
+            FlushPendingMove();
+
+            move_cookie_ = event.cookie;
+            move_is_folder_ = is_folder;
+            move_from_ = std::move(name);
+
+            return;
+        }
+
+        if ((event.mask & IN_MOVED_TO) && move_cookie_ && (event.cookie == move_cookie_))
+        {
+            if (is_folder)
+                RenameWatches(move_from_ + "/", name + "/");
+
+            if (report)
+                batch_.OnRenamed(move_from_, name);
+
+            move_cookie_ = 0;
+
+            return;
+        }
+
+        FlushPendingMove();
+
+        if (event.mask & (IN_CREATE | IN_MOVED_TO))
+        {
+            if (report)
+                batch_.OnAdded(name);
+
+            if (is_folder)
+                AddWatches(name + "/", true);
+        }
+        else if (event.mask & IN_DELETE)
+        {
+            if (report)
+                batch_.OnRemoved(name);
+        }
+        else if (!is_folder && (event.mask & (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_ACCESS)))
+        {
+            batch_.OnModified(name);
+        }
+    }
+
+    void PosixFileSystemWatcher::FlushPendingMove()
+    {
+        if (move_cookie_ == 0)
+            return;
+
+        // Moved somewhere outside of the watched folder
+        if (move_is_folder_)
+            RemoveWatches(move_from_ + "/");
+
+        if (filter_ & (move_is_folder_ ? NotifyFilter::FolderName : NotifyFilter::FileName))
+            batch_.OnRemoved(move_from_);
+
+        move_cookie_ = 0;
+    }
+#endif
+
+    PosixMappedFileStream::PosixMappedFileStream(const u8* data, u64 size)
+        : MappedFileStream(data, size)
+    {}
+
+    PosixMappedFileStream::~PosixMappedFileStream()
+    {
+        if (data_)
+            munmap(const_cast<u8*>(data_), static_cast<size_t>(size_));
+    }
+
+    void PosixMappedFileStream::Advise(u64 offset, u64 len, AccessPattern pattern)
+    {
+        if (offset >= size_)
+            return;
+
+        len = std::min<u64>(size_ - offset, len);
+
+        int advice = MADV_NORMAL;
+
+        switch (pattern)
+        {
+            case AccessPattern::Normal: advice = MADV_NORMAL; break;
+            case AccessPattern::Sequential: advice = MADV_SEQUENTIAL; break;
+            case AccessPattern::Random: advice = MADV_RANDOM; break;
+            case AccessPattern::WillNeed: advice = MADV_WILLNEED; break;
+            case AccessPattern::DontNeed: advice = MADV_DONTNEED; break;
+        }
+
+        // madvise requires a page aligned address
+        static usize const page_size = static_cast<usize>(sysconf(_SC_PAGESIZE));
+
+        usize const align = static_cast<usize>(offset) & (page_size - 1);
+
+        madvise(const_cast<u8*>(data_) + offset - align, static_cast<usize>(len) + align, advice);
+    }
+
+    PosixFindFileHandle::PosixFindFileHandle(DIR* handle)
+        : handle_(handle)
+    {}
+
+    PosixFindFileHandle::~PosixFindFileHandle()
+    {
+        if (handle_)
+            closedir(handle_);
+    }
+
+    bool PosixFindFileHandle::Next(FolderEntry& entry)
+    {
+        entry.Reset();
+
+        while (dirent* data = readdir(handle_))
+        {
+            // Skip "." and ".." directories
+            if ((data->d_name[0] == '.') &&
+                ((data->d_name[1] == '\0') || (data->d_name[1] == '.' && data->d_name[2] == '\0')))
+                continue;
+
+            struct stat info;
+
+            if (fstatat(dirfd(handle_), data->d_name, &info, 0) != 0)
+                continue;
+
+            entry.Name = data->d_name;
+            entry.IsFolder = S_ISDIR(info.st_mode);
+            entry.Size = entry.IsFolder ? 0 : static_cast<u64>(info.st_size);
+
+            return true;
+        }
+
+        return false;
+    }
+
+    static inline Rc<Stream> PosixCreateFile(const char* path, int flags)
+    {
+        int fd = open(path, flags | O_CLOEXEC, 0666);
+
+        if (fd == -1)
+            return nullptr;
+
+        return MakeUnique<PosixFileStream>(fd);
+    }
+
+    static inline bool PosixCreateFolder(const char* path)
+    {
+        return (mkdir(path, 0777) == 0) || (errno == EEXIST);
+    }
+
+    static inline bool PosixDeleteFile(const char* path)
+    {
+        return unlink(path) == 0;
+    }
+
+    static inline bool PosixDeleteFolder(const char* path)
+    {
+        return rmdir(path) == 0;
+    }
+
+    static inline bool PosixFileExists(const char* path)
+    {
+        struct stat info;
+
+        return (stat(path, &info) == 0) && !S_ISDIR(info.st_mode);
+    }
+
+    static inline bool PosixFolderExists(const char* path)
+    {
+        struct stat info;
+
+        return (stat(path, &info) == 0) && S_ISDIR(info.st_mode);
+    }
+
+    static const char* PosixGetTempPath()
+    {
+        const char* result = std::getenv("TMPDIR");
+
+        return (result && result[0]) ? result : "/tmp";
+    }
+
+    bool PlatformIoInit()
+    {
+        return true;
+    }
+
+    void PlatformIoShutdown()
+    {}
+
+    Rc<Stream> PlatformOpenFile(StringView path, bool read_only)
+    {
+        char npath[PATH_MAX];
+
+        if (PosixToNativePath(path, npath, std::size(npath)) == 0)
+            return nullptr;
+
+        if (!PosixFileExists(npath))
+            return nullptr;
+
+        return PosixCreateFile(npath, read_only ? O_RDONLY : O_RDWR);
+    }
+
+    Rc<Stream> PlatformCreateFile(StringView path, bool write_only, bool truncate)
+    {
+        char npath[PATH_MAX];
+
+        if (PosixToNativePath(path, npath, std::size(npath)) == 0)
+            return nullptr;
+
+        return PosixCreateFile(npath, (write_only ? O_WRONLY : O_RDWR) | O_CREAT | (truncate ? O_TRUNC : 0));
+    }
+
+    Rc<MappedFileStream> PlatformMapFile(StringView path)
+    {
+        char npath[PATH_MAX];
+
+        if (PosixToNativePath(path, npath, std::size(npath)) == 0)
+            return nullptr;
+
+        int fd = open(npath, O_RDONLY | O_CLOEXEC);
+
+        if (fd == -1)
+            return nullptr;
+
+        struct stat info;
+
+        if ((fstat(fd, &info) != 0) || !S_ISREG(info.st_mode) ||
+            (static_cast<u64>(info.st_size) > static_cast<u64>(SIZE_MAX)))
+        {
+            close(fd);
+
+            return nullptr;
+        }
+
+        u64 const size = static_cast<u64>(info.st_size);
+        void* data = nullptr;
+
+        // mmap rejects empty mappings, an empty file is just an empty view
+        if (size != 0)
+        {
+            data = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (data == MAP_FAILED)
+                data = nullptr;
+        }
+
+        // The mapping keeps its own reference to the file
+        close(fd);
+
+        if ((size != 0) && (data == nullptr))
+            return nullptr;
+
+        return MakeRc<PosixMappedFileStream>(static_cast<const u8*>(data), size);
+    }
+
+    Ptr<IoQueue> PlatformCreateIoQueue(u32 depth)
+    {
+#ifdef IR_POSIX_IO_URING
+        Ptr<PosixUringQueue> queue = MakeUnique<PosixUringQueue>();
+
+        if (queue->Init(depth))
+            return queue;
+#else
+        (void) depth;
+#endif
+
+        return MakeUnique<IoQueue>();
+    }
+
+    Ptr<FindFileHandle> PlatformFindFiles(StringView path)
+    {
+        // There are no volumes to enumerate, everything lives under "/"
+        if (path.empty())
+            return nullptr;
+
+        char npath[PATH_MAX];
+
+        usize converted = PosixToNativePath(path, npath, std::size(npath));
+
+        if (converted == 0)
+            return nullptr;
+
+        if (npath[converted - 1] != '/')
+            return nullptr;
+
+        DIR* handle = opendir(npath);
+
+        if (handle == nullptr)
+            return nullptr;
+
+        return MakeUnique<PosixFindFileHandle>(handle);
+    }
+
+    Ptr<FileSystemWatcher> PlatformCreateFileSystemWatcher(StringView path, NotifyFilters filter)
+    {
+#ifdef IR_POSIX_INOTIFY
+        char npath[PATH_MAX];
+
+        usize converted = PosixToNativePath(path, npath, std::size(npath));
+
+        if (converted == 0)
+            return nullptr;
+
+        if (!PosixFolderExists(npath))
+            return nullptr;
+
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+        if (fd == -1)
+            return nullptr;
+
+        String root(npath, converted);
+
+        if (root.back() != '/')
+            root.push_back('/');
+
+        return MakeUnique<PosixFileSystemWatcher>(fd, std::move(root), filter);
+#else
+        (void) path;
+        (void) filter;
+
+        return nullptr;
+#endif
+    }
+
+    Rc<Stream> PlatformTempStream()
+    {
+        const char* temp_path = PosixGetTempPath();
+
+#ifdef O_TMPFILE
+        // Anonymous file, never visible in the file system and released on close
+        if (int fd = open(temp_path, O_TMPFILE | O_RDWR | O_CLOEXEC, 0600); fd != -1)
+            return MakeRc<PosixFileStream>(fd);
+#endif
+
+#ifdef MFD_CLOEXEC
+        // Not every file system supports O_TMPFILE, fall back to an anonymous file in memory
+        // Unlike our own buffers, it can still be swapped out
+        if (int fd = memfd_create("IrTemp", MFD_CLOEXEC); fd != -1)
+            return MakeRc<PosixFileStream>(fd);
+#endif
+
+        char npath[PATH_MAX];
+
+        if (std::snprintf(npath, std::size(npath), "%s/IrXXXXXX", temp_path) >= int(std::size(npath)))
+            return nullptr;
+
+        int fd = mkstemp(npath);
+
+        if (fd == -1)
+            return nullptr;
+
+        unlink(npath);
+
+        return MakeRc<PosixFileStream>(fd);
+    }
+
+    bool PlatformCreateFolder(StringView path, bool recursive)
+    {
+        char npath[PATH_MAX];
+
+        if (PosixToNativePath(path, npath, std::size(npath)) == 0)
+            return false;
+
+        if (PosixFolderExists(npath))
+            return true;
+
+        if (!recursive)
+            return PosixCreateFolder(npath);
+
+        bool exists = true;
+
+        // Skip the leading slash of absolute paths
+        for (char* j = std::strchr(npath + 1, '/'); j; j = std::strchr(j + 1, '/'))
+        {
+            *j = '\0';
+
+            if (exists)
+                exists = PosixFolderExists(npath);
+
+            if (!exists && !PosixCreateFolder(npath))
+                return false;
+
+            *j = '/';
+        }
+
+        return PosixFolderExists(npath) || PosixCreateFolder(npath);
+    }
+
+    bool PlatformDeleteFile(StringView path)
+    {
+        char npath[PATH_MAX];
+
+        if (PosixToNativePath(path, npath, std::size(npath)) == 0)
+            return false;
+
+        return !PosixFileExists(npath) || PosixDeleteFile(npath);
+    }
+
+    bool PlatformDeleteFolder(StringView path)
+    {
+        char npath[PATH_MAX];
+
+        if (PosixToNativePath(path, npath, std::size(npath)) == 0)
+            return false;
+
+        return !PosixFolderExists(npath) || PosixDeleteFolder(npath);
+    }
+
+    bool PlatformFileExists(StringView path)
+    {
+        char npath[PATH_MAX];
+
+        if (PosixToNativePath(path, npath, std::size(npath)) == 0)
+            return false;
+
+        return PosixFileExists(npath);
+    }
+
+    bool PlatformFolderExists(StringView path)
+    {
+        char npath[PATH_MAX];
+
+        if (PosixToNativePath(path, npath, std::size(npath)) == 0)
+            return false;
+
+        return PosixFolderExists(npath);
+    }
+
+    String PlatformPathExpandEnvStrings(StringView path)
+    {
+        // Expands $NAME and ${NAME}, leaving unknown variables untouched (matching ExpandEnvironmentStrings)
+        String result;
+        result.reserve(path.size());
+
+        for (usize i = 0; i < path.size();)
+        {
+            if (path[i] != '$')
+            {
+                result.push_back(path[i++]);
+
+                continue;
+            }
+
+            bool const braced = (i + 1 < path.size()) && (path[i + 1] == '{');
+
+            usize const start = i + (braced ? 2 : 1);
+            usize end = start;
+
+            while ((end < path.size()) && (std::isalnum(static_cast<unsigned char>(path[end])) || path[end] == '_'))
+                ++end;
+
+            usize const next = end + ((braced && end < path.size() && path[end] == '}') ? 1 : 0);
+
+            const char* value = nullptr;
+
+            if ((end != start) && (!braced || next != end))
+                value = std::getenv(String(path.substr(start, end - start)).c_str());
+
+            if (value)
+            {
+                result += value;
+                i = next;
+            }
+            else
+            {
+                result.push_back(path[i++]);
+            }
+        }
+
+        return result;
+    }
+} // namespace Iridium
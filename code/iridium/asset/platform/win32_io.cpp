@@ -1,7 +1,9 @@
 #include "asset/filewatcher.h"
 #include "asset/findhandle.h"
+#include "asset/ioqueue.h"
 #include "asset/platform_io.h"
 #include "asset/stream.h"
+#include "asset/stream/mapped.h"
 
 #include "core/platform/minwin.h"
 
@@ -51,6 +53,15 @@ namespace Iridium
         ~Win32TempFileStream() override;
     };
 
+    class Win32MappedFileStream final : public MappedFileStream
+    {
+    public:
+        Win32MappedFileStream(const u8* data, u64 size);
+        ~Win32MappedFileStream() override;
+
+        void Advise(u64 offset, u64 len, AccessPattern pattern) override;
+    };
+
     class Win32FindFileHandle final : public FindFileHandle
     {
     public:
@@ -293,6 +304,29 @@ namespace Iridium
         Win32TempFileCache::Instance.Close(handle_);
     }
 
+    Win32MappedFileStream::Win32MappedFileStream(const u8* data, u64 size)
+        : MappedFileStream(data, size)
+    {}
+
+    Win32MappedFileStream::~Win32MappedFileStream()
+    {
+        if (data_)
+            UnmapViewOfFile(data_);
+    }
+
+    void Win32MappedFileStream::Advise(u64 offset, u64 len, AccessPattern pattern)
+    {
+        // There is no equivalent for the other patterns
+        if (pattern != AccessPattern::WillNeed || offset >= size_)
+            return;
+
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = const_cast<u8*>(data_) + offset;
+        range.NumberOfBytes = static_cast<SIZE_T>(std::min<u64>(size_ - offset, len));
+
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+
     Win32FindFileHandle::Win32FindFileHandle(const wchar_t* path)
     {
         handle_ = FindFirstFileExW(path, FindExInfoBasic, &data_, FindExSearchNameMatch, nullptr, 0);
@@ -556,18 +590,23 @@ namespace Iridium
             if (!GetOverlappedResultEx(handle_, &event_, &bytes_read, timeout, FALSE))
                 return false;
 
+            // A completed read with no data means the buffer overflowed
             if (bytes_read != 0)
-                HandleEvents(listener);
+                HandleEvents(batch_);
+            else
+                batch_.OnOverflow();
 
             RefreshWatch();
 
+            batch_.Flush(listener);
+
             return true;
         }
 
     private:
         inline bool RefreshWatch()
         {
-            return ReadDirectoryChangesW(handle_, buffer_, sizeof(buffer_), FALSE, filter_, NULL, &event_, NULL);
+            return ReadDirectoryChangesW(handle_, buffer_, sizeof(buffer_), TRUE, filter_, NULL, &event_, NULL);
         }
 
         inline void HandleEvents(FileSystemListener& listener)
@@ -623,6 +662,7 @@ namespace Iridium
         HANDLE handle_ {INVALID_HANDLE_VALUE};
         DWORD filter_ {};
         OVERLAPPED event_ {};
+        FileSystemEventBatch batch_;
         alignas(DWORD) BYTE buffer_[32 * 1024];
     };
 
@@ -675,6 +715,57 @@ namespace Iridium
             truncate ? CREATE_ALWAYS : OPEN_ALWAYS);
     }
 
+    Rc<MappedFileStream> PlatformMapFile(StringView path)
+    {
+        wchar_t wpath[MAX_PATH];
+
+        if (Win32ToNativePath(path, wpath, std::size(wpath)) == 0)
+            return nullptr;
+
+        HANDLE handle = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+        if (handle == INVALID_HANDLE_VALUE)
+            return nullptr;
+
+        LARGE_INTEGER size;
+        size.QuadPart = 0;
+
+        if (!GetFileSizeEx(handle, &size) || (static_cast<u64>(size.QuadPart) > SIZE_MAX))
+        {
+            CloseHandle(handle);
+
+            return nullptr;
+        }
+
+        const void* data = nullptr;
+
+        // CreateFileMappingW rejects empty files, an empty file is just an empty view
+        if (size.QuadPart != 0)
+        {
+            if (HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr))
+            {
+                data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+                // The view keeps its own reference to the mapping
+                CloseHandle(mapping);
+            }
+        }
+
+        CloseHandle(handle);
+
+        if ((size.QuadPart != 0) && (data == nullptr))
+            return nullptr;
+
+        return MakeRc<Win32MappedFileStream>(static_cast<const u8*>(data), static_cast<u64>(size.QuadPart));
+    }
+
+    Ptr<IoQueue> PlatformCreateIoQueue(u32)
+    {
+        // There is no native queue on Windows, reads submitted to it are performed synchronously
+        return MakeUnique<IoQueue>();
+    }
+
     Ptr<FindFileHandle> PlatformFindFiles(StringView path)
     {
         if (path.empty())
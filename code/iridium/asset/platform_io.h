@@ -3,8 +3,10 @@
 namespace Iridium
 {
     class Stream;
+    class MappedFileStream;
     class FindFileHandle;
     class FileSystemWatcher;
+    class IoQueue;
 
     namespace NotifyFilter
     {
@@ -27,6 +29,15 @@ namespace Iridium
     // Returns a handle to the new file, or null on error
     Rc<Stream> PlatformCreateFile(StringView path, bool write_only, bool truncate);
 
+    // Maps a file into memory for reading
+    // Returns a handle to the mapped file, or null on error
+    Rc<MappedFileStream> PlatformMapFile(StringView path);
+
+    // Creates a queue for asynchronous reads, with room for at least depth reads in flight
+    // Returns the new queue, which completes reads synchronously if there is no native support
+    // Only Linux (through io_uring) has native support
+    Ptr<IoQueue> PlatformCreateIoQueue(u32 depth);
+
     // Enumerates files in the specified folder
     // Returns a handle for file enumeration, or null on error
     Ptr<FindFileHandle> PlatformFindFiles(StringView path);
@@ -6,9 +6,12 @@ iridium_component "IrAsset"
 
     filter "system:not Windows"
         excludes { "platform/win32_io.cpp" }
+    filter "system:Windows"
+        excludes { "platform/posix_io.cpp" }
     filter {}
 
     includeZlib()
     includeOodle()
+    includeZstd()
 
-    links { "zlib", "oodle" }
+    links { "zlib", "oodle", "zstd" }
@@ -2,8 +2,11 @@
 
 #include "core/meta/metadefine.h"
 #include "platform_io.h"
+#include "stream/blockcache.h"
 #include "stream/buffered.h"
+#include "stream/mapped.h"
 #include "stream/sync.h"
+#include "stream/temp.h"
 
 namespace Iridium
 {
@@ -103,6 +106,53 @@ namespace Iridium
         return (Seek(offset, SeekWhence::Set) == static_cast<i64>(offset)) ? Write(ptr, len) : 0;
     }
 
+    /*
+        ssize_t preadv(int fd, const struct iovec* iov, int iovcnt, off_t offset);
+
+        BOOL ReadFileScatter(HANDLE hFile, FILE_SEGMENT_ELEMENT aSegmentArray[], DWORD nNumberOfBytesToRead, LPDWORD lpReserved, LPOVERLAPPED lpOverlapped);
+    */
+    usize Stream::ReadBulkV(IoRange* ranges, usize count)
+    {
+        usize completed = 0;
+
+        for (usize i = 0; i < count; ++i)
+        {
+            IoRange& range = ranges[i];
+
+            range.Result = ReadBulk(range.Data, range.Length, range.Offset);
+
+            if (range.Result == range.Length)
+                ++completed;
+        }
+
+        return completed;
+    }
+
+    usize Stream::ReadAll(void* ptr, usize len)
+    {
+        return ReadBulk(ptr, len, 0);
+    }
+
+    /*
+        int io_uring_enter(int fd, u32 to_submit, u32 min_complete, u32 flags, sigset_t* sig);
+
+        BOOL ReadFileEx(HANDLE hFile, LPVOID lpBuffer, DWORD nNumberOfBytesToRead, LPOVERLAPPED lpOverlapped, LPOVERLAPPED_COMPLETION_ROUTINE lpCompletionRoutine);
+    */
+    void Stream::SubmitReadBulk(
+        IoQueue& queue, void* ptr, usize len, u64 offset, IoCompletion completion, void* context)
+    {
+        queue.Complete(completion, context, ReadBulk(ptr, len, offset));
+    }
+
+    /*
+        int posix_fadvise(int fd, off_t offset, off_t len, int advice);
+        int madvise(void* addr, size_t length, int advice);
+
+        BOOL PrefetchVirtualMemory(HANDLE hProcess, ULONG_PTR NumberOfEntries, PWIN32_MEMORY_RANGE_ENTRY VirtualAddresses, ULONG Flags);
+    */
+    void Stream::Advise(u64, u64, AccessPattern)
+    {}
+
     /*
         int fsync(int fd);
         int fdatasync(int fd);
@@ -150,6 +200,36 @@ namespace Iridium
         return total;
     }
 
+    /*
+        ssize_t copy_file_range(int fd_in, off64_t* off_in, int fd_out, off64_t* off_out, size_t len, unsigned int flags);
+        ssize_t sendfile(int out_fd, int in_fd, off_t* offset, size_t count);
+
+        BOOL CopyFileExW(LPCWSTR lpExistingFileName, LPCWSTR lpNewFileName, LPPROGRESS_ROUTINE lpProgressRoutine, LPVOID lpData, LPBOOL pbCancel, DWORD dwCopyFlags);
+    */
+    u64 Stream::CopyBulkTo(Stream& output, u64 offset, u64 len)
+    {
+        u64 total = 0;
+
+        u8 buffer[32768];
+
+        while (total < len)
+        {
+            usize n = ReadBulk(buffer, static_cast<usize>(std::min<u64>(len - total, sizeof(buffer))), offset + total);
+
+            if (n == 0)
+                break;
+
+            n = output.Write(buffer, n);
+
+            if (n == 0)
+                break;
+
+            total += n;
+        }
+
+        return total;
+    }
+
     Rc<Stream> Stream::GetBulkStream(u64&, u64)
     {
         return nullptr;
@@ -165,6 +245,11 @@ namespace Iridium
         return false;
     }
 
+    bool Stream::CanReadAsync() const
+    {
+        return false;
+    }
+
     Rc<BufferedStream> Stream::Buffered(Rc<Stream> stream)
     {
         if (stream->IsA<BufferedStream>())
@@ -189,9 +274,18 @@ namespace Iridium
         return MakeRc<SyncStream>(std::move(stream));
     }
 
+    Rc<Stream> Stream::Cached(Rc<Stream> stream)
+    {
+        // Mapped files are already backed by the page cache
+        if (stream->IsA<BlockCacheStream>() || stream->IsA<MappedFileStream>())
+            return stream;
+
+        return MakeRc<BlockCacheStream>(std::move(stream));
+    }
+
     Rc<Stream> Stream::Temp()
     {
-        return PlatformTempStream();
+        return MakeRc<TempStream>();
     }
 
     VIRTUAL_META_DEFINE_CHILD("Stream", Stream, AtomicRefCounted)
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "asset/ioqueue.h"
+
 namespace Iridium
 {
     enum class SeekWhence : u8
@@ -9,6 +11,26 @@ namespace Iridium
         End
     };
 
+    // How a range of a stream is expected to be accessed
+    enum class AccessPattern : u8
+    {
+        Normal,
+        Sequential,
+        Random,
+        WillNeed,
+        DontNeed
+    };
+
+    // A single range of a vectored bulk read
+    struct IoRange
+    {
+        void* Data {nullptr};
+        usize Length {0};
+        u64 Offset {0};
+
+        usize Result {0}; // Number of bytes read into Data
+    };
+
     class BufferedStream;
 
     class Stream : public AtomicRefCounted
@@ -47,6 +69,29 @@ namespace Iridium
         // Returns the number of bytes written
         virtual usize WriteBulk(const void* ptr, usize len, u64 offset);
 
+        // Reads each of the ranges from their specified file position, storing the number of bytes read in Result
+        // Ranges may be given in any order, and nearby ranges may be merged into a single read
+        // May modify the current file position
+        // Returns the number of ranges which were read in full
+        virtual usize ReadBulkV(IoRange* ranges, usize count);
+
+        // Reads the whole stream from the start, in one go where possible
+        // May modify the current file position
+        // Returns the number of bytes read
+        virtual usize ReadAll(void* ptr, usize len);
+
+        // Queues an asynchronous read of up to len bytes from the specified file position
+        // The completion is invoked with the number of bytes read by a later call to queue.Reap
+        // ptr must remain valid until then
+        // Streams without native support perform the read immediately
+        virtual void SubmitReadBulk(
+            IoQueue& queue, void* ptr, usize len, u64 offset, IoCompletion completion, void* context);
+
+        // Hints how len bytes from the specified file position will be accessed
+        // Purely advisory, so streams are free to ignore it
+        // WillNeed lets the kernel start reading before the data is needed, e.g. while an entry's transforms are set up
+        virtual void Advise(u64 offset, u64 len, AccessPattern pattern);
+
         // Flushes any buffers, causing buffered data to be written to the underlying file
         // May modify the current file position
         // Returns true if successful
@@ -61,6 +106,11 @@ namespace Iridium
         // Returns number of bytes copied
         virtual u64 CopyTo(Stream& output);
 
+        // Copies up to len bytes from the specified file position to the current position of output
+        // May modify the current file position
+        // Returns number of bytes copied
+        virtual u64 CopyBulkTo(Stream& output, u64 offset, u64 len);
+
         // Retreives the underlying file handle usable for bulk operations
         // Returns the bulk file handle, and adjusts offset as required
         virtual Rc<Stream> GetBulkStream(u64& offset, u64 size);
@@ -75,6 +125,9 @@ namespace Iridium
         virtual bool IsBulkSync() const;
         virtual bool IsFullSync() const;
 
+        // Whether SubmitReadBulk can be performed natively, rather than reading immediately
+        virtual bool CanReadAsync() const;
+
         // virtual bool IsCompressed()
         // virtual bool IsEncrypted()
         // virtual bool IsRemote()
@@ -85,6 +138,10 @@ namespace Iridium
         static Rc<Stream> BulkSync(Rc<Stream> stream);
         static Rc<Stream> FullSync(Rc<Stream> stream);
 
+        // Shares a block cache between all readers of stream
+        // Archives don't cache their input themselves, so wrap it before opening one whose entries are read repeatedly
+        static Rc<Stream> Cached(Rc<Stream> stream);
+
         static Rc<Stream> Temp();
 
         [[nodiscard]] bool TrySeek(u64 position);
@@ -0,0 +1,326 @@
+#include "blockcache.h"
+
+#include "mapped.h"
+
+#include "core/mutex.h"
+
+#include "core/meta/metadefine.h"
+
+namespace Iridium
+{
+    struct CachedBlock final : AtomicRefCounted
+    {
+        u64 Owner {0};
+        u64 Index {0};
+
+        usize Length {0};
+
+        // Set whenever the block is used, and cleared as the clock hand passes
+        bool Referenced {true};
+
+        u8 Data[BlockCacheStream::BlockSize];
+    };
+
+    class BlockCache
+    {
+    public:
+        Rc<CachedBlock> Find(u64 owner, u64 index);
+
+        // Adds a block to the cache, evicting others as required
+        // Returns the cached block, which may have been added by another thread in the meantime
+        Rc<CachedBlock> Insert(Rc<CachedBlock> block);
+
+        // Evicts all blocks belonging to owner
+        void Remove(u64 owner);
+
+        void SetBudget(usize total);
+
+        u64 NextOwner();
+
+    private:
+        // Evicts blocks until there is room for another one
+        // Returns the slot to place it in
+        usize Reserve();
+
+        void Evict(usize slot);
+
+        Mutex lock_;
+
+        std::unordered_map<Tuple<u64, u64>, usize, HashTuple<u64, u64>> lookup_;
+
+        Vec<Rc<CachedBlock>> slots_;
+        Vec<usize> free_;
+
+        usize hand_ {0};
+
+        usize used_ {0};
+        usize budget_ {64 * 1024 * 1024};
+
+        u64 next_owner_ {0};
+    };
+
+    Rc<CachedBlock> BlockCache::Find(u64 owner, u64 index)
+    {
+        MutexGuard lock(lock_);
+
+        auto find = lookup_.find(Tuple<u64, u64> {owner, index});
+
+        if (find == lookup_.end())
+            return nullptr;
+
+        Rc<CachedBlock>& block = slots_[find->second];
+
+        block->Referenced = true;
+
+        return block;
+    }
+
+    Rc<CachedBlock> BlockCache::Insert(Rc<CachedBlock> block)
+    {
+        MutexGuard lock(lock_);
+
+        if (budget_ < BlockCacheStream::BlockSize)
+            return block;
+
+        auto [iter, inserted] = lookup_.try_emplace(Tuple<u64, u64> {block->Owner, block->Index}, 0);
+
+        if (!inserted)
+            return slots_[iter->second];
+
+        usize const slot = Reserve();
+
+        iter->second = slot;
+        slots_[slot] = block;
+        used_ += BlockCacheStream::BlockSize;
+
+        return block;
+    }
+
+    void BlockCache::Remove(u64 owner)
+    {
+        MutexGuard lock(lock_);
+
+        for (usize i = 0; i < slots_.size(); ++i)
+        {
+            if (slots_[i] && (slots_[i]->Owner == owner))
+                Evict(i);
+        }
+    }
+
+    void BlockCache::SetBudget(usize total)
+    {
+        MutexGuard lock(lock_);
+
+        budget_ = total;
+
+        for (usize i = 0; (i < slots_.size()) && (used_ > budget_); ++i)
+        {
+            if (slots_[i])
+                Evict(i);
+        }
+    }
+
+    u64 BlockCache::NextOwner()
+    {
+        MutexGuard lock(lock_);
+
+        return ++next_owner_;
+    }
+
+    usize BlockCache::Reserve()
+    {
+        while (used_ + BlockCacheStream::BlockSize > budget_)
+        {
+            usize const slot = hand_;
+
+            hand_ = (hand_ + 1) % slots_.size();
+
+            if (slots_[slot] == nullptr)
+                continue;
+
+            if (slots_[slot]->Referenced)
+                slots_[slot]->Referenced = false;
+            else
+                Evict(slot);
+        }
+
+        if (!free_.empty())
+        {
+            usize const slot = free_.back();
+            free_.pop_back();
+
+            return slot;
+        }
+
+        slots_.emplace_back();
+
+        return slots_.size() - 1;
+    }
+
+    void BlockCache::Evict(usize slot)
+    {
+        Rc<CachedBlock>& block = slots_[slot];
+
+        lookup_.erase(Tuple<u64, u64> {block->Owner, block->Index});
+        block.reset();
+
+        free_.push_back(slot);
+        used_ -= BlockCacheStream::BlockSize;
+    }
+
+    static BlockCache& GetBlockCache()
+    {
+        static BlockCache cache;
+
+        return cache;
+    }
+
+    BlockCacheStream::BlockCacheStream(Rc<Stream> input)
+        : input_(Stream::BulkSync(std::move(input)))
+        , size_(input_->Size())
+        , id_(GetBlockCache().NextOwner())
+    {}
+
+    BlockCacheStream::~BlockCacheStream()
+    {
+        GetBlockCache().Remove(id_);
+    }
+
+    i64 BlockCacheStream::Seek(i64 offset, SeekWhence whence)
+    {
+        switch (whence)
+        {
+            case SeekWhence::Set: break;
+            case SeekWhence::Cur: offset += here_; break;
+            case SeekWhence::End: offset += size_; break;
+        }
+
+        if (offset < 0)
+            return -1;
+
+        here_ = offset;
+
+        return here_;
+    }
+
+    i64 BlockCacheStream::Tell()
+    {
+        return here_;
+    }
+
+    i64 BlockCacheStream::Size()
+    {
+        return size_;
+    }
+
+    usize BlockCacheStream::Read(void* ptr, usize len)
+    {
+        usize result = ReadBulk(ptr, len, here_);
+
+        here_ += result;
+
+        return result;
+    }
+
+    usize BlockCacheStream::ReadBulk(void* ptr, usize len, u64 offset)
+    {
+        if (offset >= static_cast<u64>(size_))
+            return 0;
+
+        len = static_cast<usize>(std::min<u64>(size_ - offset, len));
+
+        BlockCache& cache = GetBlockCache();
+
+        usize total = 0;
+
+        while (total < len)
+        {
+            u64 const index = (offset + total) / BlockSize;
+            usize const here = static_cast<usize>((offset + total) % BlockSize);
+
+            Rc<CachedBlock> block = cache.Find(id_, index);
+
+            if (block == nullptr)
+            {
+                block = MakeRc<CachedBlock>();
+
+                block->Owner = id_;
+                block->Index = index;
+                block->Length = input_->ReadBulk(block->Data, BlockSize, index * BlockSize);
+
+                // Don't keep partial reads around, as the data is likely just missing
+                if ((block->Length == BlockSize) || (index * BlockSize + block->Length == static_cast<u64>(size_)))
+                    block = cache.Insert(std::move(block));
+            }
+
+            if (here >= block->Length)
+                break;
+
+            usize const copied = std::min(block->Length - here, len - total);
+
+            std::memcpy(static_cast<u8*>(ptr) + total, block->Data + here, copied);
+
+            total += copied;
+        }
+
+        return total;
+    }
+
+    usize BlockCacheStream::ReadBulkV(IoRange* ranges, usize count)
+    {
+        return input_->ReadBulkV(ranges, count);
+    }
+
+    void BlockCacheStream::SubmitReadBulk(
+        IoQueue& queue, void* ptr, usize len, u64 offset, IoCompletion completion, void* context)
+    {
+        input_->SubmitReadBulk(queue, ptr, len, offset, completion, context);
+    }
+
+    void BlockCacheStream::Advise(u64 offset, u64 len, AccessPattern pattern)
+    {
+        input_->Advise(offset, len, pattern);
+    }
+
+    u64 BlockCacheStream::CopyBulkTo(Stream& output, u64 offset, u64 len)
+    {
+        // Bulk copies are usually one-off, so bypass the cache rather than flushing out everything else
+        return input_->CopyBulkTo(output, offset, len);
+    }
+
+    Rc<Stream> BlockCacheStream::GetBulkStream(u64& offset, u64 size)
+    {
+        if ((offset + size) > static_cast<u64>(size_))
+            return nullptr;
+
+        // Mapped data is already in memory, so hand it out directly rather than copying it through the cache
+        u64 bulk_offset = offset;
+
+        if (Rc<Stream> bulk = input_->GetBulkStream(bulk_offset, size); bulk && bulk->IsA<MappedFileStream>())
+        {
+            offset = bulk_offset;
+
+            return bulk;
+        }
+
+        return AddRc(this);
+    }
+
+    bool BlockCacheStream::IsBulkSync() const
+    {
+        return true;
+    }
+
+    bool BlockCacheStream::CanReadAsync() const
+    {
+        return input_->CanReadAsync();
+    }
+
+    void BlockCacheStream::SetMemoryBudget(usize total)
+    {
+        GetBlockCache().SetBudget(total);
+    }
+
+    VIRTUAL_META_DEFINE_CHILD("BlockCacheStream", BlockCacheStream, Stream)
+    {}
+} // namespace Iridium
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "asset/stream.h"
+
+namespace Iridium
+{
+    // A read-only stream which keeps fixed size blocks of its input in memory
+    // Blocks from every BlockCacheStream share one memory budget, and are evicted in CLOCK order
+    // Created through Stream::Cached, which callers opt into for archives whose entries are read repeatedly
+    class BlockCacheStream final : public Stream
+    {
+    public:
+        static constexpr usize BlockSize = 0x10000;
+
+        BlockCacheStream(Rc<Stream> input);
+        ~BlockCacheStream() override;
+
+        i64 Seek(i64 offset, SeekWhence whence) override;
+
+        i64 Tell() override;
+        i64 Size() override;
+
+        usize Read(void* ptr, usize len) override;
+        usize ReadBulk(void* ptr, usize len, u64 offset) override;
+
+        // Vectored and asynchronous reads go straight to the input, like bulk copies
+        usize ReadBulkV(IoRange* ranges, usize count) override;
+
+        void SubmitReadBulk(
+            IoQueue& queue, void* ptr, usize len, u64 offset, IoCompletion completion, void* context) override;
+
+        void Advise(u64 offset, u64 len, AccessPattern pattern) override;
+
+        u64 CopyBulkTo(Stream& output, u64 offset, u64 len) override;
+
+        Rc<Stream> GetBulkStream(u64& offset, u64 size) override;
+
+        bool IsBulkSync() const override;
+
+        bool CanReadAsync() const override;
+
+        // Sets the total size of cached blocks, across all streams
+        // Defaults to 64MB, and a budget of 0 disables caching
+        static void SetMemoryBudget(usize total);
+
+        VIRTUAL_META_DECLARE;
+
+    private:
+        Rc<Stream> input_ {nullptr};
+
+        i64 size_ {0};
+        i64 here_ {0};
+
+        // Identifies this stream's blocks in the shared cache
+        u64 id_ {0};
+    };
+} // namespace Iridium
@@ -1,5 +1,7 @@
 #include "buffered.h"
 
+#include "asset/platform_io.h"
+
 #include "core/meta/metadefine.h"
 
 namespace Iridium
@@ -15,6 +17,7 @@ namespace Iridium
     BufferedStream::~BufferedStream()
     {
         FlushWrites();
+        CancelReadAhead();
     }
 
     i64 BufferedStream::Size()
@@ -24,6 +27,12 @@ namespace Iridium
 
     i64 BufferedStream::Seek(i64 offset, SeekWhence whence)
     {
+        if (raw_stale_ && (whence == SeekWhence::Cur))
+        {
+            offset += Tell();
+            whence = SeekWhence::Set;
+        }
+
         if (buffer_read_ != 0)
         {
             i64 rel_offset = offset;
@@ -57,6 +66,8 @@ namespace Iridium
         buffer_head_ = 0;
         buffer_read_ = 0;
 
+        raw_stale_ = false;
+
         return position_;
     }
 
@@ -67,6 +78,11 @@ namespace Iridium
             return 0;
         }
 
+        if (queue_)
+        {
+            return ReadAhead(ptr, len);
+        }
+
         usize total = 0;
 
         if (usize const buffered = buffer_read_ - buffer_head_; len > buffered)
@@ -173,7 +189,10 @@ namespace Iridium
             return 0;
         }
 
+        CancelReadAhead();
+
         position_ = -1;
+        raw_stale_ = false;
 
         return handle_->ReadBulk(ptr, len, offset);
     }
@@ -185,7 +204,10 @@ namespace Iridium
             return 0;
         }
 
+        CancelReadAhead();
+
         position_ = -1;
+        raw_stale_ = false;
 
         return handle_->WriteBulk(ptr, len, offset);
     }
@@ -232,8 +254,187 @@ namespace Iridium
         return FlushBuffer() && handle_->Flush();
     }
 
+    void BufferedStream::SetReadAhead(u32 depth)
+    {
+        FlushReads();
+
+        queue_.reset();
+        chunks_.clear();
+
+        // Without asynchronous reads, reading ahead would just mean blocking on several reads instead of one
+        if ((depth == 0) || !handle_->CanReadAsync())
+        {
+            return;
+        }
+
+        queue_ = PlatformCreateIoQueue(depth);
+
+        if (!queue_->IsAsync())
+        {
+            queue_.reset();
+
+            return;
+        }
+
+        chunks_.resize(depth);
+
+        for (ReadAheadChunk& chunk : chunks_)
+        {
+            chunk.Data.reset(new u8[buffer_capacity_]);
+        }
+    }
+
+    usize BufferedStream::ReadAhead(void* ptr, usize len)
+    {
+        usize total = 0;
+
+        while (len != 0)
+        {
+            usize const buffered = buffer_read_ - buffer_head_;
+
+            if (buffered == 0)
+            {
+                position_ += static_cast<u64>(buffer_head_);
+
+                buffer_head_ = 0;
+                buffer_read_ = 0;
+
+                if (FetchChunk() == 0)
+                {
+                    break;
+                }
+
+                continue;
+            }
+
+            usize const copied = std::min(buffered, len);
+
+            std::memcpy(ptr, &buffer_[buffer_head_], copied);
+            buffer_head_ += static_cast<u32>(copied);
+
+            ptr = static_cast<u8*>(ptr) + copied;
+            len -= copied;
+            total += copied;
+        }
+
+        return total;
+    }
+
+    usize BufferedStream::FetchChunk()
+    {
+        // Anything queued from before a seek is no use
+        if ((chunk_count_ != 0) && (chunks_[chunk_head_].Offset != static_cast<u64>(position_)))
+        {
+            CancelReadAhead();
+        }
+
+        if (chunk_count_ == 0)
+        {
+            chunk_next_ = position_;
+            chunk_eof_ = false;
+        }
+
+        QueueChunks();
+
+        if (chunk_count_ == 0)
+        {
+            return 0;
+        }
+
+        ReadAheadChunk& chunk = chunks_[chunk_head_];
+
+        while (!chunk.Done && queue_->Reap(1))
+            ;
+
+        if (!chunk.Done)
+        {
+            CancelReadAhead();
+
+            return 0;
+        }
+
+        chunk_head_ = (chunk_head_ + 1) % chunks_.size();
+        --chunk_count_;
+
+        // The chunk becomes the buffer, and the old buffer is recycled for the next chunk
+        std::swap(buffer_, chunk.Data);
+
+        buffer_head_ = 0;
+        buffer_read_ = static_cast<u32>(chunk.Length);
+
+        raw_stale_ = true;
+
+        if (buffer_read_ < buffer_capacity_)
+        {
+            chunk_eof_ = true;
+        }
+
+        QueueChunks();
+
+        return buffer_read_;
+    }
+
+    void BufferedStream::QueueChunks()
+    {
+        if (chunk_eof_)
+        {
+            return;
+        }
+
+        while (chunk_count_ < chunks_.size())
+        {
+            ReadAheadChunk& chunk = chunks_[(chunk_head_ + chunk_count_) % chunks_.size()];
+
+            chunk.Offset = chunk_next_;
+            chunk.Length = 0;
+            chunk.Done = false;
+
+            chunk_next_ += buffer_capacity_;
+            ++chunk_count_;
+
+            handle_->SubmitReadBulk(*queue_, chunk.Data.get(), buffer_capacity_, chunk.Offset, OnChunkRead, &chunk);
+        }
+
+        queue_->Submit();
+    }
+
+    void BufferedStream::CancelReadAhead()
+    {
+        if (queue_)
+        {
+            queue_->Drain();
+        }
+
+        chunk_head_ = 0;
+        chunk_count_ = 0;
+    }
+
+    void BufferedStream::OnChunkRead(void* context, usize result)
+    {
+        ReadAheadChunk* chunk = static_cast<ReadAheadChunk*>(context);
+
+        chunk->Length = result;
+        chunk->Done = true;
+    }
+
     IR_FORCEINLINE bool BufferedStream::FlushReads()
     {
+        if (raw_stale_)
+        {
+            CancelReadAhead();
+
+            // Reading ahead leaves the underlying file position wherever it was, so restore it before writing
+            if (position_ >= 0)
+            {
+                position_ = handle_->Seek(position_ + buffer_head_, SeekWhence::Set);
+            }
+
+            buffer_head_ = 0;
+            buffer_read_ = 0;
+
+            raw_stale_ = false;
+        }
+
         if (buffer_read_ != 0 && buffer_read_ != buffer_head_ && position_ >= 0)
         {
             position_ = handle_->Seek(position_ + buffer_head_, SeekWhence::Set);
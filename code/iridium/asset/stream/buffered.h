@@ -25,6 +25,12 @@ namespace Iridium
         // Flushes the buffer to the underlying file without then flushing the underlying file
         bool FlushBuffer();
 
+        // Keeps up to depth further buffers of data queued for reading past the current one
+        // Reads are asynchronous, so parsing can overlap with I/O, and this does nothing where they are not supported
+        // Intended for sequential reads, and cancelled by any seek outside the buffer or write
+        // A depth of 0 disables read-ahead
+        void SetReadAhead(u32 depth);
+
         i32 GetCh();
         i32 UnGetCh(i32 ch);
 
@@ -40,6 +46,28 @@ namespace Iridium
         bool FlushReads();
         bool FlushWrites();
 
+        struct ReadAheadChunk
+        {
+            Ptr<u8[]> Data {nullptr};
+            u64 Offset {0};
+            usize Length {0};
+            bool Done {false};
+        };
+
+        usize ReadAhead(void* ptr, usize len);
+
+        // Replaces the buffer with the next chunk, starting at position_
+        // Returns the number of bytes now buffered
+        usize FetchChunk();
+
+        // Queues reads until there are depth chunks in flight
+        void QueueChunks();
+
+        // Waits for all queued chunks, and discards them
+        void CancelReadAhead();
+
+        static void OnChunkRead(void* context, usize result);
+
         // Underlying file handle
         Rc<Stream> handle_ {};
 
@@ -58,6 +86,23 @@ namespace Iridium
 
         // Number of bytes read from the file for buffering
         u32 buffer_read_ {0};
+
+        // Ring of chunks being read ahead of the buffer
+        Vec<ReadAheadChunk> chunks_ {};
+        u32 chunk_head_ {0};
+        u32 chunk_count_ {0};
+
+        // File position of the next chunk to queue
+        u64 chunk_next_ {0};
+
+        // Set once a chunk comes back short, so no more are queued
+        bool chunk_eof_ {false};
+
+        // Set when the underlying file position no longer matches position_, after reading ahead
+        bool raw_stale_ {false};
+
+        // Declared after chunks_, so any reads still in flight are completed before the chunks are freed
+        Ptr<IoQueue> queue_ {nullptr};
     };
 
     inline i64 BufferedStream::Tell()
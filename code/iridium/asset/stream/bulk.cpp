@@ -45,11 +45,51 @@ namespace Iridium
         return input_->ReadBulk(ptr, len, offset);
     }
 
+    usize BulkStream::ReadBulkV(IoRange* ranges, usize count)
+    {
+        return input_->ReadBulkV(ranges, count);
+    }
+
+    void BulkStream::SubmitReadBulk(
+        IoQueue& queue, void* ptr, usize len, u64 offset, IoCompletion completion, void* context)
+    {
+        input_->SubmitReadBulk(queue, ptr, len, offset, completion, context);
+    }
+
+    void BulkStream::Advise(u64 offset, u64 len, AccessPattern pattern)
+    {
+        input_->Advise(offset, len, pattern);
+    }
+
+    u64 BulkStream::CopyTo(Stream& output)
+    {
+        i64 const size = input_->Size();
+
+        if (here_ < 0 || here_ >= size)
+            return 0;
+
+        u64 result = input_->CopyBulkTo(output, here_, size - here_);
+
+        here_ += result;
+
+        return result;
+    }
+
+    u64 BulkStream::CopyBulkTo(Stream& output, u64 offset, u64 len)
+    {
+        return input_->CopyBulkTo(output, offset, len);
+    }
+
     bool BulkStream::IsBulkSync() const
     {
         return input_->IsBulkSync();
     }
 
+    bool BulkStream::CanReadAsync() const
+    {
+        return input_->CanReadAsync();
+    }
+
     Rc<Stream> BulkStream::GetBulkStream(u64&, u64)
     {
         return input_;
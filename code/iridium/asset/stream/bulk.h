@@ -16,9 +16,20 @@ namespace Iridium
 
         usize Read(void* ptr, usize len) override;
         usize ReadBulk(void* ptr, usize len, u64 offset) override;
+        usize ReadBulkV(IoRange* ranges, usize count) override;
+
+        void SubmitReadBulk(
+            IoQueue& queue, void* ptr, usize len, u64 offset, IoCompletion completion, void* context) override;
+
+        void Advise(u64 offset, u64 len, AccessPattern pattern) override;
+
+        u64 CopyTo(Stream& output) override;
+        u64 CopyBulkTo(Stream& output, u64 offset, u64 len) override;
 
         bool IsBulkSync() const override;
 
+        bool CanReadAsync() const override;
+
         Rc<Stream> GetBulkStream(u64& offset, u64 size) override;
 
     private:
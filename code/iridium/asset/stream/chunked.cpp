@@ -0,0 +1,348 @@
+#include "chunked.h"
+
+#include "asset/transform.h"
+
+#include "core/bits.h"
+#include "core/parallel.h"
+
+namespace Iridium
+{
+    using namespace bits;
+
+    // Written after the frame index
+    struct ChunkedFooter
+    {
+        le<u64> Size;
+        le<u32> FrameCount;
+        le<u32> FrameSize;
+        u8 Compressor;
+        u8 Reserved[3];
+        le<u32> Magic;
+    };
+
+    static_assert(sizeof(ChunkedFooter) == 0x18);
+
+    static constexpr u32 ChunkedMagic = 0x4B4E4843; // CHNK
+
+    // Smallest read worth giving each thread, below which frames are decoded inline
+    static constexpr usize ChunkedParallelMinRange = 0x80000;
+
+    ChunkedEncodeStream::ChunkedEncodeStream(Rc<Stream> output, CompressorId compressor, usize frame_size)
+        : output_(std::move(output))
+        , compressor_(compressor)
+        , transform_(CreateEncodeTransform(compressor))
+        , frame_size_(frame_size)
+    {
+        frame_ = PooledBuffer(frame_size_);
+    }
+
+    ChunkedEncodeStream::~ChunkedEncodeStream()
+    {
+        Flush();
+    }
+
+    i64 ChunkedEncodeStream::Tell()
+    {
+        return size_;
+    }
+
+    i64 ChunkedEncodeStream::Size()
+    {
+        return size_;
+    }
+
+    usize ChunkedEncodeStream::Write(const void* ptr, usize len)
+    {
+        if (finished_ || (transform_ == nullptr))
+            return 0;
+
+        usize total = 0;
+
+        while (total < len)
+        {
+            usize const n = std::min(len - total, frame_size_ - frame_len_);
+
+            std::memcpy(&frame_[frame_len_], static_cast<const u8*>(ptr) + total, n);
+
+            frame_len_ += n;
+            total += n;
+
+            if ((frame_len_ == frame_size_) && !WriteFrame())
+                break;
+        }
+
+        size_ += total;
+
+        return total;
+    }
+
+    bool ChunkedEncodeStream::Flush()
+    {
+        if (finished_)
+            return true;
+
+        finished_ = true;
+
+        if (transform_ == nullptr)
+            return false;
+
+        if (frame_len_ && !WriteFrame())
+            return false;
+
+        usize const frame_count = frame_sizes_.size();
+
+        Vec<le<u32>> index(frame_sizes_.begin(), frame_sizes_.end());
+
+        ChunkedFooter footer {};
+        footer.Size = size_;
+        footer.FrameCount = static_cast<u32>(frame_count);
+        footer.FrameSize = static_cast<u32>(frame_size_);
+        footer.Compressor = static_cast<u8>(compressor_);
+        footer.Magic = ChunkedMagic;
+
+        return output_->TryWrite(index.data(), index.size() * sizeof(index[0])) &&
+            output_->TryWrite(&footer, sizeof(footer));
+    }
+
+    bool ChunkedEncodeStream::WriteFrame()
+    {
+        if (!transform_->Reset())
+            return false;
+
+        transform_->NextIn = &frame_[0];
+        transform_->AvailIn = frame_len_;
+        transform_->Finished = true;
+
+        u8 buffer[0x4000];
+
+        u64 written = 0;
+
+        while (true)
+        {
+            transform_->NextOut = buffer;
+            transform_->AvailOut = sizeof(buffer);
+
+            if (!transform_->Update())
+                return false;
+
+            usize const len = sizeof(buffer) - transform_->AvailOut;
+
+            if (len == 0)
+                break;
+
+            if (!output_->TryWrite(buffer, len))
+                return false;
+
+            written += len;
+        }
+
+        frame_sizes_.push_back(static_cast<u32>(written));
+        frame_len_ = 0;
+
+        return true;
+    }
+
+    ChunkedDecodeStream::ChunkedDecodeStream(Rc<Stream> input)
+        : input_(Stream::BulkSync(std::move(input)))
+    {
+        i64 const input_size = input_->Size();
+
+        ChunkedFooter footer;
+
+        if ((input_size < i64(sizeof(footer))) ||
+            !input_->TryReadBulk(&footer, sizeof(footer), input_size - sizeof(footer)))
+            return;
+
+        if ((footer.Magic != ChunkedMagic) || (footer.FrameSize == 0))
+            return;
+
+        u64 const frame_count = footer.FrameCount;
+
+        if (frame_count != (footer.Size + footer.FrameSize - 1) / footer.FrameSize)
+            return;
+
+        u64 const index_size = frame_count * sizeof(le<u32>);
+
+        if (u64(input_size) - sizeof(footer) < index_size)
+            return;
+
+        u64 const index_offset = input_size - sizeof(footer) - index_size;
+
+        Vec<le<u32>> index(static_cast<usize>(frame_count));
+
+        if (!input_->TryReadBulk(index.data(), static_cast<usize>(index_size), index_offset))
+            return;
+
+        offsets_.resize(index.size() + 1);
+
+        for (usize i = 0; i < index.size(); ++i)
+            offsets_[i + 1] = offsets_[i] + index[i];
+
+        if (offsets_.back() != index_offset)
+            return;
+
+        size_ = footer.Size;
+        frame_size_ = footer.FrameSize;
+        compressor_ = static_cast<CompressorId>(footer.Compressor);
+    }
+
+    ChunkedDecodeStream::~ChunkedDecodeStream() = default;
+
+    i64 ChunkedDecodeStream::Seek(i64 offset, SeekWhence whence)
+    {
+        switch (whence)
+        {
+            case SeekWhence::Set: break;
+            case SeekWhence::Cur: offset += here_; break;
+            case SeekWhence::End: offset += size_; break;
+        }
+
+        here_ = std::clamp<i64>(offset, 0, size_);
+
+        return here_;
+    }
+
+    i64 ChunkedDecodeStream::Tell()
+    {
+        return here_;
+    }
+
+    i64 ChunkedDecodeStream::Size()
+    {
+        return size_;
+    }
+
+    usize ChunkedDecodeStream::Read(void* ptr, usize len)
+    {
+        usize const result = ReadBulk(ptr, len, here_);
+
+        here_ += result;
+
+        return result;
+    }
+
+    usize ChunkedDecodeStream::ReadBulk(void* ptr, usize len, u64 offset)
+    {
+        if (!IsValid() || (offset >= size_))
+            return 0;
+
+        len = static_cast<usize>(std::min<u64>(len, size_ - offset));
+
+        if (len == 0)
+            return 0;
+
+        usize const first = static_cast<usize>(offset / frame_size_);
+        usize const count = static_cast<usize>((offset + len - 1) / frame_size_) - first + 1;
+
+        // Frames are decoded independently, but only large reads are worth spreading across threads
+        usize const thread_count = std::min<usize>(parallel_get_thread_count(), len / ChunkedParallelMinRange);
+
+        Vec<u8> done(count);
+
+        parallel_for_n(count, thread_count, [&](usize /*thread_index*/, usize i) {
+            Ptr<BinaryTransform> transform = AcquireTransform();
+
+            if (transform == nullptr)
+                return;
+
+            usize const index = first + i;
+
+            u64 const frame_start = index * frame_size_;
+            u64 const frame_end = std::min(frame_start + frame_size_, size_);
+
+            u64 const start = std::max(frame_start, offset);
+            u64 const end = std::min(frame_end, offset + len);
+
+            u8* const output = static_cast<u8*>(ptr) + (start - offset);
+
+            // Whole frames are decoded straight into the output
+            done[i] = ((start == frame_start) && (end == frame_end))
+                ? DecodeFrame(*transform, index, output)
+                : ReadFrame(*transform, index, output, static_cast<usize>(start - frame_start),
+                      static_cast<usize>(end - start));
+
+            ReleaseTransform(std::move(transform));
+        });
+
+        // Only count the data up to the first frame which failed
+        for (usize i = 0; i < count; ++i)
+        {
+            if (!done[i])
+                return static_cast<usize>(std::max((first + i) * frame_size_, offset) - offset);
+        }
+
+        return len;
+    }
+
+    bool ChunkedDecodeStream::IsBulkSync() const
+    {
+        return true;
+    }
+
+    Ptr<BinaryTransform> ChunkedDecodeStream::AcquireTransform()
+    {
+        {
+            MutexGuard guard(lock_);
+
+            if (!transforms_.empty())
+            {
+                Ptr<BinaryTransform> result = std::move(transforms_.back());
+                transforms_.pop_back();
+
+                return result;
+            }
+        }
+
+        return CreateDecodeTransform(compressor_, static_cast<i64>(frame_size_));
+    }
+
+    void ChunkedDecodeStream::ReleaseTransform(Ptr<BinaryTransform> transform)
+    {
+        MutexGuard guard(lock_);
+
+        transforms_.push_back(std::move(transform));
+    }
+
+    bool ChunkedDecodeStream::DecodeFrame(BinaryTransform& transform, usize index, u8* output)
+    {
+        u64 const frame_start = index * frame_size_;
+        usize const frame_len = static_cast<usize>(std::min(frame_size_, size_ - frame_start));
+
+        usize const raw_len = static_cast<usize>(offsets_[index + 1] - offsets_[index]);
+
+        PooledBuffer input(raw_len);
+
+        if (!input_->TryReadBulk(input.get(), raw_len, offsets_[index]))
+            return false;
+
+        return transform.DecodeAll(input.get(), raw_len, output, frame_len) == frame_len;
+    }
+
+    bool ChunkedDecodeStream::ReadFrame(BinaryTransform& transform, usize index, u8* output, usize offset, usize len)
+    {
+        {
+            MutexGuard guard(lock_);
+
+            if (cached_frame_ == index)
+            {
+                std::memcpy(output, &cached_[offset], len);
+
+                return true;
+            }
+        }
+
+        PooledBuffer frame(static_cast<usize>(frame_size_));
+
+        if (!DecodeFrame(transform, index, frame.get()))
+            return false;
+
+        std::memcpy(output, &frame[offset], len);
+
+        MutexGuard guard(lock_);
+
+        cached_ = std::move(frame);
+        cached_frame_ = index;
+
+        return true;
+    }
+} // namespace Iridium
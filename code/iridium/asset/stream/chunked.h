@@ -0,0 +1,105 @@
+#pragma once
+
+#include "asset/bufferpool.h"
+#include "asset/compressorid.h"
+#include "asset/stream.h"
+
+#include "core/mutex.h"
+
+namespace Iridium
+{
+    class BinaryTransform;
+
+    // A compressed container made of independently compressed frames, followed by an index of their sizes
+    // Every frame holds the same amount of decoded data, apart from the last, so any offset maps straight to a frame
+
+    // Writes a chunked container, compressing each frame as it fills up
+    // The index is written by Flush, after which no more data can be written
+    class ChunkedEncodeStream final : public Stream
+    {
+    public:
+        ChunkedEncodeStream(Rc<Stream> output, CompressorId compressor, usize frame_size = 0x40000);
+        ~ChunkedEncodeStream() override;
+
+        i64 Tell() override;
+        i64 Size() override;
+
+        usize Write(const void* ptr, usize len) override;
+
+        bool Flush() override;
+
+    private:
+        Rc<Stream> output_;
+        CompressorId compressor_ {};
+        Ptr<BinaryTransform> transform_;
+
+        usize frame_size_ {0};
+
+        PooledBuffer frame_;
+        usize frame_len_ {0};
+
+        Vec<u32> frame_sizes_;
+
+        u64 size_ {0};
+
+        bool finished_ {false};
+
+        bool WriteFrame();
+    };
+
+    // Reads a chunked container, decoding only the frames which are needed
+    // Large reads spanning multiple frames decode them in parallel
+    class ChunkedDecodeStream final : public Stream
+    {
+    public:
+        ChunkedDecodeStream(Rc<Stream> input);
+        ~ChunkedDecodeStream() override;
+
+        // Checks whether the input was a valid container
+        bool IsValid() const;
+
+        i64 Seek(i64 offset, SeekWhence whence) override;
+
+        i64 Tell() override;
+        i64 Size() override;
+
+        usize Read(void* ptr, usize len) override;
+        usize ReadBulk(void* ptr, usize len, u64 offset) override;
+
+        bool IsBulkSync() const override;
+
+    private:
+        Rc<Stream> input_;
+        CompressorId compressor_ {CompressorId::Invalid};
+
+        u64 frame_size_ {0};
+        u64 size_ {0};
+
+        // Offset of each frame in the input, plus the end of the last frame
+        Vec<u64> offsets_;
+
+        i64 here_ {0};
+
+        Mutex lock_;
+
+        // The most recently decoded frame, for reads which only need part of one
+        PooledBuffer cached_;
+        usize cached_frame_ {SIZE_MAX};
+
+        // Decoders left over from previous reads, one for each frame decoded at the same time
+        Vec<Ptr<BinaryTransform>> transforms_;
+
+        Ptr<BinaryTransform> AcquireTransform();
+        void ReleaseTransform(Ptr<BinaryTransform> transform);
+
+        bool DecodeFrame(BinaryTransform& transform, usize index, u8* output);
+
+        // Copies part of a frame, decoding the whole frame if it is not already cached
+        bool ReadFrame(BinaryTransform& transform, usize index, u8* output, usize offset, usize len);
+    };
+
+    inline bool ChunkedDecodeStream::IsValid() const
+    {
+        return compressor_ != CompressorId::Invalid;
+    }
+} // namespace Iridium
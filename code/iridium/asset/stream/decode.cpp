@@ -2,15 +2,100 @@
 
 #include "asset/transform.h"
 
+#include "mapped.h"
+
 namespace Iridium
 {
+    // Small entries are read in one go, and larger ones in chunks which grow with the entry
+    static usize GetDecodeBufferSize(u64 input_size)
+    {
+        if (input_size == 0)
+            return 0x10000;
+
+        if (input_size <= 0x10000)
+            return static_cast<usize>(input_size);
+
+        if (input_size <= 0x100000)
+            return 0x10000;
+
+        return 0x40000;
+    }
+
     DecodeStream::DecodeStream(Rc<Stream> handle, Ptr<BinaryTransform> transform, u64 size, usize buffer_size)
         : input_(std::move(handle))
         , transform_(std::move(transform))
         , size_(size)
         , buffer_size_(buffer_size)
     {
-        buffer_.reset(new u8[buffer_size_]);
+        u64 offset = 0;
+        u64 const input_size = static_cast<u64>(std::max<i64>(input_->Size(), 0));
+
+        if (Rc<Stream> bulk = input_->GetBulkStream(offset, input_size); bulk && bulk->IsA<MappedFileStream>())
+        {
+            // The mapping is kept alive by input_
+            view_ = static_cast<MappedFileStream*>(bulk.get())->GetView(offset, input_size);
+            view_size_ = input_size;
+        }
+
+        // No buffer is needed at all when the input is already in memory
+        if (view_ == nullptr)
+        {
+            if (buffer_size_ == 0)
+                buffer_size_ = GetDecodeBufferSize(input_size);
+
+            buffer_ = PooledBuffer(buffer_size_);
+        }
+
+        SetCheckpoints(0x100000, 0x40000);
+    }
+
+    usize DecodeStream::ReadAll(void* ptr, usize len)
+    {
+        len = static_cast<usize>(std::min<u64>(size_, len));
+
+        usize result = 0;
+
+        if (view_)
+        {
+            result = transform_->DecodeAll(view_, static_cast<usize>(view_size_), static_cast<u8*>(ptr), len);
+        }
+        else
+        {
+            // One large read of the whole input, rather than going through buffer_
+            i64 const input_size = input_->Size();
+
+            if (input_size <= 0)
+                return 0;
+
+            PooledBuffer input(static_cast<usize>(input_size));
+
+            usize const input_len = input_->ReadAll(input.get(), static_cast<usize>(input_size));
+
+            result = transform_->DecodeAll(input.get(), input_len, static_cast<u8*>(ptr), len);
+        }
+
+        // The transform has been left at the end, so any further reads need to seek back first
+        transform_->NextIn = nullptr;
+        transform_->AvailIn = 0;
+
+        current_ = (result == size_) ? static_cast<i64>(size_) : -1;
+
+        return result;
+    }
+
+    void DecodeStream::SetCheckpoints(u64 interval, usize budget)
+    {
+        checkpoints_.clear();
+        checkpoint_size_ = 0;
+
+        checkpoint_interval_ = interval;
+        checkpoint_budget_ = budget;
+
+        // Small entries never get far enough for a checkpoint, so don't make their transform stop early
+        if ((checkpoint_interval_ >= size_) || !transform_->EnableCheckpoints())
+            checkpoint_interval_ = 0;
+
+        next_checkpoint_ = checkpoint_interval_;
     }
 
     i64 DecodeStream::Seek(i64 offset, SeekWhence whence)
@@ -34,7 +119,17 @@ namespace Iridium
             return current_;
         }
 
-        if (offset < current_)
+        // Find the last checkpoint before the target
+        auto resume = std::upper_bound(checkpoints_.begin(), checkpoints_.end(), static_cast<u64>(offset),
+            [](u64 value, const Checkpoint& checkpoint) { return value < checkpoint.OutputOffset; });
+
+        if ((resume != checkpoints_.begin()) &&
+            ((offset < current_) || (current_ < 0) || (i64((resume - 1)->OutputOffset) > current_)))
+        {
+            if (!RestoreCheckpoint(*(resume - 1)))
+                return -1;
+        }
+        else if ((offset < current_) || (current_ < 0))
         {
             if (!input_->TrySeek(0))
                 return -1;
@@ -45,6 +140,7 @@ namespace Iridium
             transform_->NextIn = nullptr;
             transform_->AvailIn = 0;
 
+            input_read_ = 0;
             current_ = 0;
         }
 
@@ -93,12 +189,23 @@ namespace Iridium
 
         while (transform_->AvailOut && !transform_->Finished)
         {
-            if (!transform_->AvailIn)
+            if (!transform_->AvailIn && view_)
+            {
+                // Input is only fed once, after that it is exhausted
+                if (transform_->NextIn == view_ + view_size_)
+                    break;
+
+                transform_->NextIn = view_;
+                transform_->AvailIn = static_cast<usize>(view_size_);
+            }
+            else if (!transform_->AvailIn)
             {
                 usize raw_len = input_->Read(&buffer_[0], buffer_size_);
 
                 transform_->NextIn = &buffer_[0];
                 transform_->AvailIn = raw_len;
+
+                input_read_ += raw_len;
             }
 
             if (!transform_->Update())
@@ -107,6 +214,9 @@ namespace Iridium
 
                 break;
             }
+
+            if (checkpoint_interval_ && (current_ + (len - transform_->AvailOut) >= next_checkpoint_))
+                AddCheckpoint(current_ + (len - transform_->AvailOut));
         }
 
         len -= transform_->AvailOut;
@@ -118,4 +228,63 @@ namespace Iridium
 
         return len;
     }
+
+    void DecodeStream::AddCheckpoint(u64 output_offset)
+    {
+        Ptr<TransformCheckpoint> state = transform_->SaveCheckpoint();
+
+        if (state == nullptr)
+            return;
+
+        u64 const input_offset =
+            view_ ? static_cast<u64>(transform_->NextIn - view_) : input_read_ - transform_->AvailIn;
+
+        checkpoint_size_ += state->Size;
+        checkpoints_.push_back({input_offset, output_offset, std::move(state)});
+
+        // Thin out the checkpoints, keeping them evenly spread
+        if (checkpoint_size_ > checkpoint_budget_)
+        {
+            checkpoint_interval_ *= 2;
+            checkpoint_size_ = 0;
+
+            usize kept = 0;
+
+            for (usize i = 1; i < checkpoints_.size(); i += 2)
+            {
+                checkpoint_size_ += checkpoints_[i].State->Size;
+                checkpoints_[kept++] = std::move(checkpoints_[i]);
+            }
+
+            checkpoints_.resize(kept);
+        }
+
+        next_checkpoint_ = output_offset + checkpoint_interval_;
+    }
+
+    bool DecodeStream::RestoreCheckpoint(const Checkpoint& checkpoint)
+    {
+        if (!transform_->RestoreCheckpoint(*checkpoint.State))
+            return false;
+
+        if (view_)
+        {
+            transform_->NextIn = view_ + checkpoint.InputOffset;
+            transform_->AvailIn = static_cast<usize>(view_size_ - checkpoint.InputOffset);
+        }
+        else
+        {
+            if (!input_->TrySeek(checkpoint.InputOffset))
+                return false;
+
+            transform_->NextIn = nullptr;
+            transform_->AvailIn = 0;
+
+            input_read_ = checkpoint.InputOffset;
+        }
+
+        current_ = checkpoint.OutputOffset;
+
+        return true;
+    }
 } // namespace Iridium
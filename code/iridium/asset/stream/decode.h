@@ -1,15 +1,18 @@
 #pragma once
 
+#include "asset/bufferpool.h"
 #include "asset/stream.h"
 
 namespace Iridium
 {
     class BinaryTransform;
+    class TransformCheckpoint;
 
     class DecodeStream final : public Stream
     {
     public:
-        DecodeStream(Rc<Stream> handle, Ptr<BinaryTransform> transform, u64 size, usize buffer_size = 0x2000);
+        // A buffer_size of 0 picks one based on the size of the input
+        DecodeStream(Rc<Stream> handle, Ptr<BinaryTransform> transform, u64 size, usize buffer_size = 0);
 
         i64 Seek(i64 offset, SeekWhence whence) override;
 
@@ -18,6 +21,13 @@ namespace Iridium
 
         usize Read(void* ptr, usize len) override;
 
+        usize ReadAll(void* ptr, usize len) override;
+
+        // Records a checkpoint about every interval bytes of output, which seeks can then resume decoding from
+        // Once the checkpoints use more than budget bytes, the interval is doubled and every other one dropped
+        // An interval of 0 disables checkpoints
+        void SetCheckpoints(u64 interval, usize budget);
+
     private:
         Rc<Stream> input_;
         Ptr<BinaryTransform> transform_;
@@ -25,7 +35,37 @@ namespace Iridium
         u64 size_ {0};
         i64 current_ {0};
 
-        Ptr<u8[]> buffer_;
+        PooledBuffer buffer_;
         usize buffer_size_ {0};
+
+        // Direct view of the input, if it is memory mapped
+        // Fed to the transform in one go instead of being copied through buffer_
+        const u8* view_ {nullptr};
+        u64 view_size_ {0};
+
+        // Number of bytes read from input_ into buffer_
+        u64 input_read_ {0};
+
+        struct Checkpoint
+        {
+            u64 InputOffset {0};
+            u64 OutputOffset {0};
+
+            Ptr<TransformCheckpoint> State {nullptr};
+        };
+
+        // Sorted by OutputOffset
+        Vec<Checkpoint> checkpoints_ {};
+
+        u64 checkpoint_interval_ {0};
+        usize checkpoint_budget_ {0};
+        usize checkpoint_size_ {0};
+
+        // Output offset at which to try making the next checkpoint
+        u64 next_checkpoint_ {0};
+
+        void AddCheckpoint(u64 output_offset);
+
+        bool RestoreCheckpoint(const Checkpoint& checkpoint);
     };
 } // namespace Iridium
@@ -5,11 +5,17 @@
 namespace Iridium
 {
     EncodeStream::EncodeStream(Rc<Stream> output, Ptr<BinaryTransform> transform, usize buffer_size)
+        : EncodeStream(std::move(output), *transform, buffer_size)
+    {
+        owned_transform_ = std::move(transform);
+    }
+
+    EncodeStream::EncodeStream(Rc<Stream> output, BinaryTransform& transform, usize buffer_size)
         : output_(std::move(output))
-        , transform_(std::move(transform))
+        , transform_(&transform)
         , buffer_size_(buffer_size)
     {
-        buffer_.reset(new u8[buffer_size_]);
+        buffer_ = PooledBuffer(buffer_size_);
     }
 
     EncodeStream::~EncodeStream()
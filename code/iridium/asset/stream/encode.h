@@ -1,5 +1,6 @@
 #pragma once
 
+#include "asset/bufferpool.h"
 #include "asset/stream.h"
 
 namespace Iridium
@@ -9,7 +10,10 @@ namespace Iridium
     class EncodeStream final : public Stream
     {
     public:
-        EncodeStream(Rc<Stream> output, Ptr<BinaryTransform> transform, usize buffer_size = 0x2000);
+        EncodeStream(Rc<Stream> output, Ptr<BinaryTransform> transform, usize buffer_size = 0x10000);
+
+        // Uses a transform owned by the caller, which must outlive the stream
+        EncodeStream(Rc<Stream> output, BinaryTransform& transform, usize buffer_size = 0x10000);
         ~EncodeStream() override;
 
         i64 Tell() override;
@@ -21,11 +25,12 @@ namespace Iridium
 
     private:
         Rc<Stream> output_;
-        Ptr<BinaryTransform> transform_;
+        Ptr<BinaryTransform> owned_transform_;
+        BinaryTransform* transform_ {nullptr};
 
         u64 size_ {0};
 
-        Ptr<u8[]> buffer_;
+        PooledBuffer buffer_;
         usize buffer_size_ {0};
     };
 } // namespace Iridium
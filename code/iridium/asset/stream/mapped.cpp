@@ -0,0 +1,95 @@
+#include "mapped.h"
+
+#include "core/meta/metadefine.h"
+
+namespace Iridium
+{
+    MappedFileStream::MappedFileStream(const u8* data, u64 size)
+        : data_(data)
+        , size_(size)
+    {}
+
+    MappedFileStream::~MappedFileStream() = default;
+
+    i64 MappedFileStream::Seek(i64 offset, SeekWhence whence)
+    {
+        switch (whence)
+        {
+            case SeekWhence::Set: break;
+            case SeekWhence::Cur: offset += here_; break;
+            case SeekWhence::End: offset += size_; break;
+        }
+
+        if (offset < 0)
+            return -1;
+
+        here_ = offset;
+
+        return here_;
+    }
+
+    i64 MappedFileStream::Tell()
+    {
+        return here_;
+    }
+
+    i64 MappedFileStream::Size()
+    {
+        return size_;
+    }
+
+    usize MappedFileStream::Read(void* ptr, usize len)
+    {
+        usize result = ReadBulk(ptr, len, here_);
+
+        here_ += result;
+
+        return result;
+    }
+
+    usize MappedFileStream::ReadBulk(void* ptr, usize len, u64 offset)
+    {
+        if (offset >= size_)
+            return 0;
+
+        len = static_cast<usize>(std::min<u64>(size_ - offset, len));
+
+        std::memcpy(ptr, data_ + offset, len);
+
+        return len;
+    }
+
+    u64 MappedFileStream::CopyTo(Stream& output)
+    {
+        u64 result = CopyBulkTo(output, here_, size_);
+
+        here_ += result;
+
+        return result;
+    }
+
+    u64 MappedFileStream::CopyBulkTo(Stream& output, u64 offset, u64 len)
+    {
+        if (offset >= size_)
+            return 0;
+
+        // The mapping is already addressable, so hand it straight to the output
+        return output.Write(data_ + offset, static_cast<usize>(std::min<u64>(size_ - offset, len)));
+    }
+
+    Rc<Stream> MappedFileStream::GetBulkStream(u64& offset, u64 size)
+    {
+        if (GetView(offset, size) == nullptr)
+            return nullptr;
+
+        return AddRc(this);
+    }
+
+    bool MappedFileStream::IsBulkSync() const
+    {
+        return true;
+    }
+
+    VIRTUAL_META_DEFINE_CHILD("MappedFileStream", MappedFileStream, Stream)
+    {}
+} // namespace Iridium
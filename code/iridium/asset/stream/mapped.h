@@ -0,0 +1,49 @@
+#pragma once
+
+#include "asset/stream.h"
+
+namespace Iridium
+{
+    // A read-only stream backed by a memory mapped file
+    // Created through PlatformMapFile, which is responsible for unmapping the view
+    class MappedFileStream : public Stream
+    {
+    public:
+        ~MappedFileStream() override = 0;
+
+        i64 Seek(i64 offset, SeekWhence whence) override;
+
+        i64 Tell() override;
+        i64 Size() override;
+
+        usize Read(void* ptr, usize len) override;
+        usize ReadBulk(void* ptr, usize len, u64 offset) override;
+
+        u64 CopyTo(Stream& output) override;
+        u64 CopyBulkTo(Stream& output, u64 offset, u64 len) override;
+
+        Rc<Stream> GetBulkStream(u64& offset, u64 size) override;
+
+        bool IsBulkSync() const override;
+
+        // Retrieves a pointer to size bytes of the mapping, starting at offset
+        // The view is valid for as long as the stream is alive
+        // Returns the view, or null if the range is out of bounds
+        const u8* GetView(u64 offset, u64 size) const;
+
+        VIRTUAL_META_DECLARE;
+
+    protected:
+        MappedFileStream(const u8* data, u64 size);
+
+        const u8* data_ {nullptr};
+        u64 size_ {0};
+
+        u64 here_ {0};
+    };
+
+    inline const u8* MappedFileStream::GetView(u64 offset, u64 size) const
+    {
+        return ((offset <= size_) && (size <= size_ - offset)) ? data_ + offset : nullptr;
+    }
+} // namespace Iridium
@@ -1,5 +1,7 @@
 #include "partial.h"
 
+#include "mapped.h"
+
 namespace Iridium
 {
     PartialStream::PartialStream(u64 start, u64 size, const Rc<Stream>& handle)
@@ -13,6 +15,9 @@ namespace Iridium
             input_ = handle;
             start_ = start;
         }
+
+        if (input_->IsA<MappedFileStream>())
+            view_ = static_cast<MappedFileStream*>(input_.get())->GetView(start_, size_);
     }
 
     i64 PartialStream::Seek(i64 offset, SeekWhence whence)
@@ -53,9 +58,84 @@ namespace Iridium
         return ReadInternal(ptr, len, offset);
     }
 
-    bool PartialStream::IsBulkSync() const
+    usize PartialStream::ReadBulkV(IoRange* ranges, usize count)
     {
-        return input_->IsBulkSync();
+        if (view_)
+            return Stream::ReadBulkV(ranges, count);
+
+        // Translate the ranges into the input, leaving out anything past the end of this stream
+        Vec<IoRange> translated(count);
+
+        for (usize i = 0; i < count; ++i)
+        {
+            const IoRange& range = ranges[i];
+            IoRange& input = translated[i];
+
+            input.Data = range.Data;
+            input.Length =
+                (range.Offset < size_) ? static_cast<usize>(std::min<u64>(size_ - range.Offset, range.Length)) : 0;
+            input.Offset = start_ + std::min(range.Offset, size_);
+        }
+
+        input_->ReadBulkV(translated.data(), count);
+
+        usize completed = 0;
+
+        for (usize i = 0; i < count; ++i)
+        {
+            ranges[i].Result = translated[i].Result;
+
+            if (ranges[i].Result == ranges[i].Length)
+                ++completed;
+        }
+
+        return completed;
+    }
+
+    void PartialStream::SubmitReadBulk(
+        IoQueue& queue, void* ptr, usize len, u64 offset, IoCompletion completion, void* context)
+    {
+        if (offset >= size_ || view_)
+        {
+            queue.Complete(completion, context, ReadInternal(ptr, len, offset));
+
+            return;
+        }
+
+        // start_ is already relative to the bulk stream returned by GetBulkStream
+        input_->SubmitReadBulk(
+            queue, ptr, static_cast<usize>(std::min<u64>(size_ - offset, len)), start_ + offset, completion, context);
+    }
+
+    void PartialStream::Advise(u64 offset, u64 len, AccessPattern pattern)
+    {
+        if (offset >= size_)
+            return;
+
+        input_->Advise(start_ + offset, std::min<u64>(size_ - offset, len), pattern);
+    }
+
+    u64 PartialStream::CopyTo(Stream& output)
+    {
+        u64 result = CopyBulkTo(output, here_, size_ - here_);
+
+        here_ += result;
+
+        return result;
+    }
+
+    u64 PartialStream::CopyBulkTo(Stream& output, u64 offset, u64 len)
+    {
+        if (offset >= size_)
+            return 0;
+
+        len = std::min<u64>(size_ - offset, len);
+
+        if (view_)
+            return output.Write(view_ + offset, static_cast<usize>(len));
+
+        // Lets file streams copy between descriptors without passing through user space
+        return input_->CopyBulkTo(output, start_ + offset, len);
     }
 
     Rc<Stream> PartialStream::GetBulkStream(u64& offset, u64 size)
@@ -68,11 +148,30 @@ namespace Iridium
         return input_;
     }
 
+    bool PartialStream::IsBulkSync() const
+    {
+        return input_->IsBulkSync();
+    }
+
+    bool PartialStream::CanReadAsync() const
+    {
+        return (view_ == nullptr) && input_->CanReadAsync();
+    }
+
     usize PartialStream::ReadInternal(void* ptr, usize len, u64 offset)
     {
         if (offset < 0 || offset >= size_)
             return 0;
 
+        if (view_)
+        {
+            len = static_cast<usize>(std::min<u64>(size_ - offset, len));
+
+            std::memcpy(ptr, view_ + offset, len);
+
+            return len;
+        }
+
         return input_->ReadBulk(ptr, static_cast<usize>(std::min<i64>(size_ - offset, len)), start_ + offset);
     }
 } // namespace Iridium
@@ -41,6 +41,41 @@ namespace Iridium
         return input_->ReadBulk(ptr, len, offset);
     }
 
+    usize SyncStream::ReadBulkV(IoRange* ranges, usize count)
+    {
+        MutexGuard lock(lock_);
+
+        return input_->ReadBulkV(ranges, count);
+    }
+
+    void SyncStream::SubmitReadBulk(
+        IoQueue& queue, void* ptr, usize len, u64 offset, IoCompletion completion, void* context)
+    {
+        // Native reads don't touch the file position, and queueing one may complete others
+        // Those completions could use this stream, so must not be invoked with the lock held
+        if (input_->CanReadAsync())
+        {
+            input_->SubmitReadBulk(queue, ptr, len, offset, completion, context);
+
+            return;
+        }
+
+        usize result = 0;
+
+        {
+            MutexGuard lock(lock_);
+
+            result = input_->ReadBulk(ptr, len, offset);
+        }
+
+        queue.Complete(completion, context, result);
+    }
+
+    void SyncStream::Advise(u64 offset, u64 len, AccessPattern pattern)
+    {
+        input_->Advise(offset, len, pattern);
+    }
+
     bool SyncStream::IsBulkSync() const
     {
         return true;
@@ -50,4 +85,9 @@ namespace Iridium
     {
         return true;
     }
+
+    bool SyncStream::CanReadAsync() const
+    {
+        return input_->CanReadAsync();
+    }
 } // namespace Iridium
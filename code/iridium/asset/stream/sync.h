@@ -17,10 +17,18 @@ namespace Iridium
 
         usize Read(void* ptr, usize len) override;
         usize ReadBulk(void* ptr, usize len, u64 offset) override;
+        usize ReadBulkV(IoRange* ranges, usize count) override;
+
+        void SubmitReadBulk(
+            IoQueue& queue, void* ptr, usize len, u64 offset, IoCompletion completion, void* context) override;
+
+        void Advise(u64 offset, u64 len, AccessPattern pattern) override;
 
         bool IsBulkSync() const override;
         bool IsFullSync() const override;
 
+        bool CanReadAsync() const override;
+
     private:
         Rc<Stream> input_ {nullptr};
         Mutex lock_;
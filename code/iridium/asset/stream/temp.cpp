@@ -0,0 +1,234 @@
+#include "temp.h"
+
+#include "asset/platform_io.h"
+
+namespace Iridium
+{
+    Atomic<usize> TempStream::s_MemoryUsed {0};
+    Atomic<usize> TempStream::s_MemoryBudget {256 << 20};
+    Atomic<usize> TempStream::s_StreamBudget {16 << 20};
+
+    TempStream::TempStream(usize memory_limit)
+        : memory_limit_(memory_limit ? memory_limit : s_StreamBudget.load(std::memory_order_relaxed))
+    {}
+
+    TempStream::~TempStream()
+    {
+        s_MemoryUsed.fetch_sub(capacity_, std::memory_order_relaxed);
+    }
+
+    i64 TempStream::Seek(i64 offset, SeekWhence whence)
+    {
+        if (file_)
+            return file_->Seek(offset, whence);
+
+        switch (whence)
+        {
+            case SeekWhence::Set: break;
+            case SeekWhence::Cur: offset += here_; break;
+            case SeekWhence::End: offset += size_; break;
+        }
+
+        if (offset < 0)
+            return -1;
+
+        here_ = static_cast<u64>(offset);
+
+        return offset;
+    }
+
+    i64 TempStream::Tell()
+    {
+        if (file_)
+            return file_->Tell();
+
+        return here_;
+    }
+
+    i64 TempStream::Size()
+    {
+        if (file_)
+            return file_->Size();
+
+        return size_;
+    }
+
+    usize TempStream::Read(void* ptr, usize len)
+    {
+        if (file_)
+            return file_->Read(ptr, len);
+
+        usize result = ReadBulk(ptr, len, here_);
+
+        here_ += result;
+
+        return result;
+    }
+
+    usize TempStream::Write(const void* ptr, usize len)
+    {
+        if (file_)
+            return file_->Write(ptr, len);
+
+        usize result = WriteBulk(ptr, len, here_);
+
+        // WriteBulk may have spilled, in which case the file position needs updating instead
+        if (file_)
+            file_->Seek(here_ + result, SeekWhence::Set);
+        else
+            here_ += result;
+
+        return result;
+    }
+
+    usize TempStream::ReadBulk(void* ptr, usize len, u64 offset)
+    {
+        if (file_)
+            return file_->ReadBulk(ptr, len, offset);
+
+        if (offset >= size_)
+            return 0;
+
+        len = static_cast<usize>(std::min<u64>(size_ - offset, len));
+
+        std::memcpy(ptr, &buffer_[offset], len);
+
+        return len;
+    }
+
+    usize TempStream::WriteBulk(const void* ptr, usize len, u64 offset)
+    {
+        if (file_)
+            return file_->WriteBulk(ptr, len, offset);
+
+        if (!Reserve(offset + len))
+            return 0;
+
+        if (file_)
+            return file_->WriteBulk(ptr, len, offset);
+
+        // Writing past the end leaves a gap of zeros, like a file would
+        if (offset > size_)
+            std::memset(&buffer_[size_], 0, static_cast<usize>(offset - size_));
+
+        std::memcpy(&buffer_[offset], ptr, len);
+
+        size_ = std::max<usize>(size_, static_cast<usize>(offset + len));
+
+        return len;
+    }
+
+    bool TempStream::Flush()
+    {
+        if (file_)
+            return file_->Flush();
+
+        return true;
+    }
+
+    i64 TempStream::SetSize(u64 length)
+    {
+        if (file_)
+            return file_->SetSize(length);
+
+        if (!Reserve(length))
+            return -1;
+
+        if (file_)
+            return file_->SetSize(length);
+
+        if (length > size_)
+            std::memset(&buffer_[size_], 0, static_cast<usize>(length - size_));
+
+        size_ = static_cast<usize>(length);
+
+        return length;
+    }
+
+    u64 TempStream::CopyTo(Stream& output)
+    {
+        if (file_)
+            return file_->CopyTo(output);
+
+        if (here_ >= size_)
+            return 0;
+
+        // Everything is already in memory, so there is no need to go through another buffer
+        usize result = output.Write(&buffer_[here_], static_cast<usize>(size_ - here_));
+
+        here_ += result;
+
+        return result;
+    }
+
+    void TempStream::SetMemoryBudget(usize total, usize per_stream)
+    {
+        s_MemoryBudget.store(total, std::memory_order_relaxed);
+        s_StreamBudget.store(per_stream, std::memory_order_relaxed);
+    }
+
+    bool TempStream::Reserve(u64 capacity)
+    {
+        if (capacity <= capacity_)
+            return true;
+
+        if (capacity > memory_limit_)
+            return Spill();
+
+        // Grow geometrically, but try for the exact size before giving up on memory
+        usize const wanted = std::min<usize>(std::max<usize>(capacity_ * 2, 0x10000), memory_limit_);
+
+        for (usize new_capacity : {std::max<usize>(wanted, static_cast<usize>(capacity)), static_cast<usize>(capacity)})
+        {
+            usize const extra = new_capacity - capacity_;
+
+            usize const budget = s_MemoryBudget.load(std::memory_order_relaxed);
+            usize used = s_MemoryUsed.load(std::memory_order_relaxed);
+
+            bool claimed = false;
+
+            while (!claimed && (used <= budget) && (extra <= budget - used))
+                claimed = s_MemoryUsed.compare_exchange_weak(used, used + extra, std::memory_order_relaxed);
+
+            if (!claimed)
+                continue;
+
+            Ptr<u8[]> buffer(new u8[new_capacity]);
+
+            if (size_)
+                std::memcpy(&buffer[0], &buffer_[0], size_);
+
+            buffer_.swap(buffer);
+            capacity_ = new_capacity;
+
+            return true;
+        }
+
+        return Spill();
+    }
+
+    bool TempStream::Spill()
+    {
+        Rc<Stream> file = PlatformTempStream();
+
+        if (file == nullptr)
+            return false;
+
+        if (size_ && !file->TryWrite(&buffer_[0], size_))
+            return false;
+
+        if (!file->TrySeek(here_))
+            return false;
+
+        file_ = std::move(file);
+
+        buffer_.reset();
+
+        s_MemoryUsed.fetch_sub(capacity_, std::memory_order_relaxed);
+
+        capacity_ = 0;
+        size_ = 0;
+
+        return true;
+    }
+} // namespace Iridium
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "asset/stream.h"
+
+namespace Iridium
+{
+    // A temporary stream which is kept in memory, until it grows too large and spills into a temporary file
+    class TempStream final : public Stream
+    {
+    public:
+        // memory_limit is the largest size kept in memory, or 0 to use the default from SetMemoryBudget
+        TempStream(usize memory_limit = 0);
+        ~TempStream() override;
+
+        i64 Seek(i64 offset, SeekWhence whence) override;
+
+        i64 Tell() override;
+        i64 Size() override;
+
+        usize Read(void* ptr, usize len) override;
+        usize Write(const void* ptr, usize len) override;
+
+        usize ReadBulk(void* ptr, usize len, u64 offset) override;
+        usize WriteBulk(const void* ptr, usize len, u64 offset) override;
+
+        bool Flush() override;
+
+        i64 SetSize(u64 length) override;
+
+        u64 CopyTo(Stream& output) override;
+
+        // Checks whether the contents have been moved into a temporary file
+        bool IsSpilled() const;
+
+        // Sets the memory shared by all temp streams, and the default limit for each stream
+        // Streams which would exceed either limit spill into a temporary file instead
+        static void SetMemoryBudget(usize total, usize per_stream);
+
+    private:
+        // Ensures the buffer can hold capacity bytes, spilling into a file if it cannot
+        bool Reserve(u64 capacity);
+
+        bool Spill();
+
+        Ptr<u8[]> buffer_ {nullptr};
+        usize capacity_ {0};
+        usize size_ {0};
+        u64 here_ {0};
+
+        usize memory_limit_ {0};
+
+        // Non-null once spilled, after which all operations are forwarded to it
+        Rc<Stream> file_ {nullptr};
+
+        static Atomic<usize> s_MemoryUsed;
+        static Atomic<usize> s_MemoryBudget;
+        static Atomic<usize> s_StreamBudget;
+    };
+
+    inline bool TempStream::IsSpilled() const
+    {
+        return file_ != nullptr;
+    }
+} // namespace Iridium
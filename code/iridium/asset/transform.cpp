@@ -0,0 +1,71 @@
+#include "transform.h"
+
+#include "transform/deflate.h"
+#include "transform/lzss.h"
+#include "transform/zstd.h"
+
+#ifdef _WIN32
+#    include "transform/oodle.h"
+#endif
+
+namespace Iridium
+{
+    usize BinaryTransform::DecodeAll(const u8* in, usize in_len, u8* out, usize out_len)
+    {
+        if (!Reset())
+            return 0;
+
+        NextIn = in;
+        AvailIn = in_len;
+
+        NextOut = out;
+        AvailOut = out_len;
+
+        while (AvailOut && !Finished)
+        {
+            usize const avail = AvailIn + AvailOut;
+
+            if (!Update() || (AvailIn + AvailOut == avail))
+                break;
+        }
+
+        usize const result = out_len - AvailOut;
+
+        NextIn = nullptr;
+        AvailIn = 0;
+
+        NextOut = nullptr;
+        AvailOut = 0;
+
+        return result;
+    }
+
+    Ptr<BinaryTransform> CreateDecodeTransform(CompressorId compressor, [[maybe_unused]] i64 size)
+    {
+        switch (compressor)
+        {
+            case CompressorId::Deflate: return MakeUnique<InflateTransform>();
+            case CompressorId::LZSS: return MakeUnique<LzssTransform>();
+            case CompressorId::Zstd: return MakeUnique<ZstdTransform>();
+
+#ifdef _WIN32
+            // The Oodle library is only available on Windows
+            case CompressorId::Oodle: return MakeUnique<OodleTransform>(size);
+#endif
+
+            default: return nullptr;
+        }
+    }
+
+    Ptr<BinaryTransform> CreateEncodeTransform(CompressorId compressor)
+    {
+        switch (compressor)
+        {
+            case CompressorId::Deflate: return MakeUnique<DeflateTransform>();
+            case CompressorId::LZSS: return MakeUnique<LzssEncodeTransform>();
+            case CompressorId::Zstd: return MakeUnique<ZstdEncodeTransform>();
+
+            default: return nullptr;
+        }
+    }
+} // namespace Iridium
@@ -1,7 +1,19 @@
 #pragma once
 
+#include "asset/compressorid.h"
+
 namespace Iridium
 {
+    // Decoder state captured part way through a stream, which decoding can later resume from
+    class TransformCheckpoint
+    {
+    public:
+        virtual ~TransformCheckpoint() = default;
+
+        // Approximate memory used by the checkpoint
+        usize Size {0};
+    };
+
     class BinaryTransform
     {
     public:
@@ -17,5 +29,40 @@ namespace Iridium
 
         virtual bool Reset() = 0;
         virtual bool Update() = 0;
+
+        // Resets the transform, then decodes all of in, stopping once out_len bytes have been written to out
+        // Intended for whole entries already in memory, where there is no need to go through NextIn/NextOut
+        // Returns the number of bytes written
+        virtual usize DecodeAll(const u8* in, usize in_len, u8* out, usize out_len);
+
+        // Prepares the transform for creating checkpoints, which may make Update return more often
+        // Returns false if checkpoints are not supported
+        virtual bool EnableCheckpoints()
+        {
+            return false;
+        }
+
+        // Captures the state needed to resume decoding from the current position in the input and output
+        // Returns null if no checkpoint can be made here, in which case try again after the next Update
+        virtual Ptr<TransformCheckpoint> SaveCheckpoint()
+        {
+            return nullptr;
+        }
+
+        // Resumes decoding from a checkpoint created by this transform
+        // NextIn/AvailIn must then continue from the input position the checkpoint was made at
+        virtual bool RestoreCheckpoint(const TransformCheckpoint& /*checkpoint*/)
+        {
+            return false;
+        }
     };
+
+    // Creates a decoder for a compression method, for use with DecodeStream
+    // size is the decoded size, which some methods need up front
+    // Returns null if the method is not supported
+    Ptr<BinaryTransform> CreateDecodeTransform(CompressorId compressor, i64 size);
+
+    // Creates an encoder for a compression method, for use with EncodeStream
+    // Returns null if the method is not supported
+    Ptr<BinaryTransform> CreateEncodeTransform(CompressorId compressor);
 } // namespace Iridium
@@ -1,54 +1,194 @@
 #include "deflate.h"
 
 #include "core/alloc.h"
+#include "core/parallel.h"
 
 namespace Iridium
 {
-    InflateTransform::InflateTransform(i32 window_bits)
+    struct InflateCheckpoint final : TransformCheckpoint
+    {
+        // Bits of the previous input byte which have not been consumed yet
+        u8 Bits {0};
+        u8 Byte {0};
+
+        uInt WindowSize {0};
+        u8 Window[1 << MAX_WBITS];
+    };
+
+    // Streams which have already been initialised, and only need a reset to be used again
+    // Kept per thread so no locking is needed, as entries are usually opened and closed on the same thread
+    struct ZStreamCache
+    {
+        static constexpr usize MaxStreams = 8;
+
+        Vec<Ptr<z_stream>> Inflaters;
+
+        // Deflaters can only be reused with the same parameters, so each one is keyed by them
+        // deflateParams isn't used to change the level, as it may emit a block into the next stream
+        Vec<Pair<u32, Ptr<z_stream>>> Deflaters;
+
+        ~ZStreamCache()
+        {
+            for (Ptr<z_stream>& stream : Inflaters)
+                inflateEnd(stream.get());
+
+            for (Pair<u32, Ptr<z_stream>>& stream : Deflaters)
+                deflateEnd(stream.second.get());
+        }
+    };
+
+    static thread_local ZStreamCache ZStreams;
+
+    static u32 GetDeflaterKey(i32 level, i32 window_bits, i32 mem_level)
+    {
+        return (u32(level + 1) << 16) | (u32(window_bits + 64) << 8) | u32(mem_level);
+    }
+
+    static Ptr<z_stream> AcquireInflater(i32 window_bits)
+    {
+        Vec<Ptr<z_stream>>& cache = ZStreams.Inflaters;
+
+        while (!cache.empty())
+        {
+            Ptr<z_stream> result = std::move(cache.back());
+            cache.pop_back();
+
+            // Also switches between raw/zlib/gzip, reallocating the window only if its size changes
+            if (inflateReset2(result.get(), window_bits) == Z_OK)
+                return result;
+
+            inflateEnd(result.get());
+        }
+
+        Ptr<z_stream> result = MakeUnique<z_stream>();
+
+        result->zalloc = Z_alloc;
+        result->zfree = Z_free;
+
+        if (inflateInit2(result.get(), window_bits) != Z_OK)
+            return nullptr;
+
+        return result;
+    }
+
+    static void ReleaseInflater(Ptr<z_stream> stream)
+    {
+        if (stream == nullptr)
+            return;
+
+        Vec<Ptr<z_stream>>& cache = ZStreams.Inflaters;
+
+        if (cache.size() < ZStreamCache::MaxStreams)
+            cache.emplace_back(std::move(stream));
+        else
+            inflateEnd(stream.get());
+    }
+
+    static Ptr<z_stream> AcquireDeflater(i32 level, i32 window_bits, i32 mem_level)
     {
-        inflater_.zalloc = Z_alloc;
-        inflater_.zfree = Z_free;
+        Vec<Pair<u32, Ptr<z_stream>>>& cache = ZStreams.Deflaters;
+
+        u32 const key = GetDeflaterKey(level, window_bits, mem_level);
+
+        for (usize i = cache.size(); i--;)
+        {
+            if (cache[i].first != key)
+                continue;
+
+            Ptr<z_stream> result = std::move(cache[i].second);
+            cache.erase(cache.begin() + i);
+
+            if (deflateReset(result.get()) == Z_OK)
+                return result;
+
+            deflateEnd(result.get());
+
+            break;
+        }
+
+        Ptr<z_stream> result = MakeUnique<z_stream>();
+
+        result->zalloc = Z_alloc;
+        result->zfree = Z_free;
+
+        if (deflateInit2(result.get(), level, Z_DEFLATED, window_bits, mem_level, Z_DEFAULT_STRATEGY) != Z_OK)
+            return nullptr;
 
-        inflateInit2(&inflater_, window_bits);
+        return result;
     }
 
+    static void ReleaseDeflater(Ptr<z_stream> stream, u32 key)
+    {
+        if (stream == nullptr)
+            return;
+
+        Vec<Pair<u32, Ptr<z_stream>>>& cache = ZStreams.Deflaters;
+
+        if (cache.size() < ZStreamCache::MaxStreams)
+            cache.emplace_back(key, std::move(stream));
+        else
+            deflateEnd(stream.get());
+    }
+
+    InflateTransform::InflateTransform(i32 window_bits)
+        : inflater_(AcquireInflater(window_bits))
+        , window_bits_(window_bits)
+    {}
+
     InflateTransform::~InflateTransform()
     {
-        inflateEnd(&inflater_);
+        ReleaseInflater(std::move(inflater_));
     }
 
     bool InflateTransform::Reset()
     {
         Finished = false;
+        at_block_end_ = false;
 
-        return inflateReset(&inflater_) == Z_OK;
+        if (inflater_ == nullptr)
+            return false;
+
+        // A restored checkpoint switches to a raw stream, so go back to the original format
+        return inflateReset2(inflater_.get(), window_bits_) == Z_OK;
     }
 
     bool InflateTransform::Update()
     {
+        if (inflater_ == nullptr)
+            return false;
+
         int error = Z_OK;
 
+        at_block_end_ = false;
+
         while (AvailIn && AvailOut)
         {
             uInt actual_in = (AvailIn <= UINT_MAX) ? uInt(AvailIn) : UINT_MAX;
             uInt actual_out = (AvailOut <= UINT_MAX) ? uInt(AvailOut) : UINT_MAX;
 
-            inflater_.next_in = NextIn;
-            inflater_.next_out = NextOut;
+            inflater_->next_in = NextIn;
+            inflater_->next_out = NextOut;
 
-            inflater_.avail_in = actual_in;
-            inflater_.avail_out = actual_out;
+            inflater_->avail_in = actual_in;
+            inflater_->avail_out = actual_out;
 
-            error = inflate(&inflater_, Z_SYNC_FLUSH);
+            error = inflate(inflater_.get(), stop_at_blocks_ ? Z_BLOCK : Z_SYNC_FLUSH);
 
-            AvailIn -= actual_in - inflater_.avail_in;
-            AvailOut -= actual_out - inflater_.avail_out;
+            AvailIn -= actual_in - inflater_->avail_in;
+            AvailOut -= actual_out - inflater_->avail_out;
 
-            NextIn = inflater_.next_in;
-            NextOut = inflater_.next_out;
+            NextIn = inflater_->next_in;
+            NextOut = inflater_->next_out;
 
             if (error != Z_OK)
                 break;
+
+            if (stop_at_blocks_ && (inflater_->data_type & 128))
+            {
+                at_block_end_ = true;
+
+                break;
+            }
         }
 
         if (error == Z_STREAM_END)
@@ -61,28 +201,106 @@ namespace Iridium
         return error == Z_OK;
     }
 
-    DeflateTransform::DeflateTransform(i32 window_bits, i32 level, i32 mem_level)
+    usize InflateTransform::DecodeAll(const u8* in, usize in_len, u8* out, usize out_len)
     {
-        deflater_.zalloc = Z_alloc;
-        deflater_.zfree = Z_free;
+        if (!Reset())
+            return 0;
 
-        deflateInit2(&deflater_, level, Z_DEFLATED, window_bits, mem_level, Z_DEFAULT_STRATEGY);
+        inflater_->next_in = in;
+        inflater_->next_out = out;
+
+        int error = Z_OK;
+
+        // With Z_FINISH and room for the whole output, inflate decodes straight into out without maintaining a window
+        while (error == Z_OK)
+        {
+            uInt const actual_in = static_cast<uInt>(std::min<usize>(in_len, UINT_MAX));
+            uInt const actual_out = static_cast<uInt>(std::min<usize>(out_len, UINT_MAX));
+
+            inflater_->avail_in = actual_in;
+            inflater_->avail_out = actual_out;
+
+            error = inflate(inflater_.get(), ((actual_in == in_len) && (actual_out == out_len)) ? Z_FINISH : Z_NO_FLUSH);
+
+            in_len -= actual_in - inflater_->avail_in;
+            out_len -= actual_out - inflater_->avail_out;
+
+            if (actual_out == inflater_->avail_out && actual_in == inflater_->avail_in)
+                break;
+        }
+
+        Finished = (error == Z_STREAM_END);
+
+        return static_cast<usize>(inflater_->next_out - out);
     }
 
+    bool InflateTransform::EnableCheckpoints()
+    {
+        stop_at_blocks_ = true;
+
+        return true;
+    }
+
+    Ptr<TransformCheckpoint> InflateTransform::SaveCheckpoint()
+    {
+        // Only possible at the end of a block (or header), and pointless once the last block has started
+        if (!at_block_end_ || (inflater_->data_type & 64) || Finished)
+            return nullptr;
+
+        Ptr<InflateCheckpoint> result = MakeUnique<InflateCheckpoint>();
+
+        result->Size = sizeof(InflateCheckpoint);
+        result->Bits = static_cast<u8>(inflater_->data_type & 7);
+
+        // Unused bits always belong to the last byte consumed, which is still in the caller's input buffer
+        if (result->Bits)
+            result->Byte = NextIn[-1];
+
+        if (inflateGetDictionary(inflater_.get(), result->Window, &result->WindowSize) != Z_OK)
+            return nullptr;
+
+        return result;
+    }
+
+    bool InflateTransform::RestoreCheckpoint(const TransformCheckpoint& checkpoint)
+    {
+        const InflateCheckpoint& state = static_cast<const InflateCheckpoint&>(checkpoint);
+
+        Finished = false;
+        at_block_end_ = false;
+
+        // Block boundaries are in the middle of the deflate data, so any zlib/gzip header is already behind us
+        if (inflateReset2(inflater_.get(), -MAX_WBITS) != Z_OK)
+            return false;
+
+        if (state.Bits && (inflatePrime(inflater_.get(), state.Bits, state.Byte >> (8 - state.Bits)) != Z_OK))
+            return false;
+
+        return inflateSetDictionary(inflater_.get(), state.Window, state.WindowSize) == Z_OK;
+    }
+
+    DeflateTransform::DeflateTransform(i32 window_bits, i32 level, i32 mem_level)
+        : deflater_(AcquireDeflater(level, window_bits, mem_level))
+        , cache_key_(GetDeflaterKey(level, window_bits, mem_level))
+    {}
+
     DeflateTransform::~DeflateTransform()
     {
-        deflateEnd(&deflater_);
+        ReleaseDeflater(std::move(deflater_), cache_key_);
     }
 
     bool DeflateTransform::Reset()
     {
         Finished = false;
 
-        return deflateReset(&deflater_) == Z_OK;
+        return (deflater_ != nullptr) && (deflateReset(deflater_.get()) == Z_OK);
     }
 
     bool DeflateTransform::Update()
     {
+        if (deflater_ == nullptr)
+            return false;
+
         int error = Z_OK;
 
         while ((AvailIn || Finished) && AvailOut)
@@ -90,19 +308,19 @@ namespace Iridium
             uInt actual_in = (AvailIn <= UINT_MAX) ? uInt(AvailIn) : UINT_MAX;
             uInt actual_out = (AvailOut <= UINT_MAX) ? uInt(AvailOut) : UINT_MAX;
 
-            deflater_.next_in = NextIn;
-            deflater_.next_out = NextOut;
+            deflater_->next_in = NextIn;
+            deflater_->next_out = NextOut;
 
-            deflater_.avail_in = actual_in;
-            deflater_.avail_out = actual_out;
+            deflater_->avail_in = actual_in;
+            deflater_->avail_out = actual_out;
 
-            error = deflate(&deflater_, Finished ? Z_FINISH : Z_NO_FLUSH);
+            error = deflate(deflater_.get(), Finished ? Z_FINISH : Z_NO_FLUSH);
 
-            AvailIn -= actual_in - deflater_.avail_in;
-            AvailOut -= actual_out - deflater_.avail_out;
+            AvailIn -= actual_in - deflater_->avail_in;
+            AvailOut -= actual_out - deflater_->avail_out;
 
-            NextIn = deflater_.next_in;
-            NextOut = deflater_.next_out;
+            NextIn = deflater_->next_in;
+            NextOut = deflater_->next_out;
 
             if (error != Z_OK)
                 break;
@@ -117,4 +335,333 @@ namespace Iridium
 
         return error == Z_OK;
     }
+
+    // A range of the input, along with the dictionary before it
+    struct ParallelDeflateTransform::Block
+    {
+        Vec<u8> Input;
+        usize DictSize {0};
+
+        bool Last {false};
+
+        Vec<u8> Output;
+
+        bool Started {false};
+        bool Done {false};
+        bool Failed {false};
+    };
+
+    struct ParallelDeflateTransform::Deflater
+    {
+        Ptr<z_stream> Stream;
+        u32 CacheKey {0};
+
+        Deflater(i32 level, i32 mem_level)
+            : Stream(AcquireDeflater(level, -MAX_WBITS, mem_level))
+            , CacheKey(GetDeflaterKey(level, -MAX_WBITS, mem_level))
+        {}
+
+        ~Deflater()
+        {
+            ReleaseDeflater(std::move(Stream), CacheKey);
+        }
+
+        bool Compress(Block& block)
+        {
+            if ((Stream == nullptr) || (deflateReset(Stream.get()) != Z_OK))
+                return false;
+
+            if (block.DictSize &&
+                (deflateSetDictionary(Stream.get(), block.Input.data(), static_cast<uInt>(block.DictSize)) != Z_OK))
+                return false;
+
+            usize const input_len = block.Input.size() - block.DictSize;
+
+            Vec<u8>& output = block.Output;
+
+            // Room for the sync flush marker too
+            output.resize(deflateBound(Stream.get(), static_cast<uLong>(input_len)) + 16);
+
+            Stream->next_in = block.Input.data() + block.DictSize;
+            Stream->avail_in = static_cast<uInt>(input_len);
+
+            usize total = 0;
+
+            while (true)
+            {
+                Stream->next_out = output.data() + total;
+                Stream->avail_out = static_cast<uInt>(output.size() - total);
+
+                int const error = deflate(Stream.get(), block.Last ? Z_FINISH : Z_SYNC_FLUSH);
+
+                total = output.size() - Stream->avail_out;
+
+                if (block.Last ? (error == Z_STREAM_END) : ((error == Z_OK) && Stream->avail_out))
+                    break;
+
+                if ((error != Z_OK) && (error != Z_BUF_ERROR))
+                    return false;
+
+                output.resize(output.size() * 2);
+            }
+
+            output.resize(total);
+
+            // The input is no longer needed, so don't hold on to it until the output is written
+            block.Input = {};
+
+            return true;
+        }
+    };
+
+    static constexpr usize DeflateDictSize = usize(1) << MAX_WBITS;
+
+    ParallelDeflateTransform::ParallelDeflateTransform(
+        i32 level, i32 mem_level, usize block_size, usize thread_count)
+        : level_(level)
+        , mem_level_(mem_level)
+        , block_size_(block_size)
+        , thread_count_(thread_count ? thread_count : parallel_get_thread_count())
+    {
+        Reset();
+    }
+
+    ParallelDeflateTransform::~ParallelDeflateTransform()
+    {
+        CancelBlocks();
+        StopWorkers();
+    }
+
+    bool ParallelDeflateTransform::Reset()
+    {
+        CancelBlocks();
+
+        Finished = false;
+
+        input_.clear();
+        dict_size_ = 0;
+
+        done_ = false;
+
+        return true;
+    }
+
+    bool ParallelDeflateTransform::Update()
+    {
+        // Enough blocks for every worker to have another one queued while the first is written out
+        usize const max_blocks = thread_count_ * 2;
+
+        while (true)
+        {
+            while (!blocks_.empty())
+            {
+                Block& block = *blocks_.front();
+
+                {
+                    MutexGuard guard(lock_);
+
+                    if (!block.Done)
+                        break;
+                }
+
+                if (block.Failed)
+                    return false;
+
+                usize const len = std::min(block.Output.size() - output_pos_, AvailOut);
+
+                std::memcpy(NextOut, block.Output.data() + output_pos_, len);
+
+                NextOut += len;
+                AvailOut -= len;
+                output_pos_ += len;
+
+                if (output_pos_ != block.Output.size())
+                    return true;
+
+                MutexGuard guard(lock_);
+
+                blocks_.erase(blocks_.begin());
+                output_pos_ = 0;
+            }
+
+            if (done_ && blocks_.empty())
+                return true;
+
+            bool const can_queue = !done_ && (blocks_.size() < max_blocks);
+
+            if (can_queue && AvailIn)
+            {
+                usize const gathered = input_.size() - dict_size_;
+                usize const len = std::min(AvailIn, block_size_ - gathered);
+
+                input_.insert(input_.end(), NextIn, NextIn + len);
+
+                NextIn += len;
+                AvailIn -= len;
+
+                if ((gathered + len == block_size_) && !QueueBlock(false))
+                    return false;
+
+                continue;
+            }
+
+            if (can_queue && Finished)
+            {
+                if (!QueueBlock(true))
+                    return false;
+
+                continue;
+            }
+
+            // Either more input is needed, or there is nowhere to put the output of the first block
+            if (can_queue || (AvailOut == 0))
+                return true;
+
+            WaitForFirstBlock();
+        }
+    }
+
+    bool ParallelDeflateTransform::QueueBlock(bool last)
+    {
+        Ptr<Block> block = MakeUnique<Block>();
+
+        block->Input.swap(input_);
+        block->DictSize = dict_size_;
+        block->Last = last;
+
+        // Keep the end of this block as the dictionary for the next
+        usize const keep = std::min(block->Input.size(), DeflateDictSize);
+
+        input_.assign(block->Input.end() - keep, block->Input.end());
+        dict_size_ = keep;
+
+        done_ = last;
+
+        // Nothing could overlap with the last block if it is the only one left (such as a small file)
+        // Any workers are idle, so the first deflater is free to use here
+        if ((thread_count_ <= 1) || (last && blocks_.empty()))
+        {
+            if (deflaters_.empty())
+                deflaters_.emplace_back(MakeUnique<Deflater>(level_, mem_level_));
+
+            block->Started = true;
+            block->Done = true;
+            block->Failed = !deflaters_[0]->Compress(*block);
+
+            MutexGuard guard(lock_);
+
+            blocks_.emplace_back(std::move(block));
+
+            return true;
+        }
+
+        // Only start as many workers as there are blocks to work on
+        if ((workers_.size() < std::min(thread_count_, blocks_.size() + 1)) && !StartWorker())
+            return false;
+
+        {
+            MutexGuard guard(lock_);
+
+            blocks_.emplace_back(std::move(block));
+        }
+
+        work_ready_.notify_one();
+
+        return true;
+    }
+
+    void ParallelDeflateTransform::WaitForFirstBlock()
+    {
+        UniqueLock<Mutex> lock(lock_);
+
+        work_done_.wait(lock, [this] { return blocks_.front()->Done; });
+    }
+
+    void ParallelDeflateTransform::CancelBlocks()
+    {
+        UniqueLock<Mutex> lock(lock_);
+
+        blocks_.erase(
+            std::remove_if(blocks_.begin(), blocks_.end(), [](const Ptr<Block>& block) { return !block->Started; }),
+            blocks_.end());
+
+        work_done_.wait(lock, [this] {
+            return std::all_of(blocks_.begin(), blocks_.end(), [](const Ptr<Block>& block) { return block->Done; });
+        });
+
+        blocks_.clear();
+        output_pos_ = 0;
+    }
+
+    bool ParallelDeflateTransform::StartWorker()
+    {
+        // Created on this thread rather than by the worker, so the stream goes back to this thread's cache
+        if (deflaters_.size() == workers_.size())
+            deflaters_.emplace_back(MakeUnique<Deflater>(level_, mem_level_));
+
+        Deflater* deflater = deflaters_[workers_.size()].get();
+
+        if (deflater->Stream == nullptr)
+            return false;
+
+        workers_.emplace_back([this, deflater] { RunWorker(*deflater); });
+
+        return true;
+    }
+
+    void ParallelDeflateTransform::StopWorkers()
+    {
+        {
+            MutexGuard guard(lock_);
+
+            stopping_ = true;
+        }
+
+        work_ready_.notify_all();
+
+        for (std::thread& worker : workers_)
+            worker.join();
+
+        workers_.clear();
+    }
+
+    void ParallelDeflateTransform::RunWorker(Deflater& deflater)
+    {
+        UniqueLock<Mutex> lock(lock_);
+
+        while (true)
+        {
+            Block* block = nullptr;
+
+            work_ready_.wait(lock, [&] {
+                for (const Ptr<Block>& queued : blocks_)
+                {
+                    if (!queued->Started)
+                    {
+                        block = queued.get();
+
+                        return true;
+                    }
+                }
+
+                return stopping_;
+            });
+
+            if (block == nullptr)
+                break;
+
+            block->Started = true;
+
+            lock.unlock();
+
+            bool const success = deflater.Compress(*block);
+
+            lock.lock();
+
+            block->Done = true;
+            block->Failed = !success;
+
+            work_done_.notify_all();
+        }
+    }
 } // namespace Iridium
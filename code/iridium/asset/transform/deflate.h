@@ -2,6 +2,10 @@
 
 #include "asset/transform.h"
 
+#include "core/mutex.h"
+
+#include <thread>
+
 #include <zlib.h>
 
 namespace Iridium
@@ -15,8 +19,22 @@ namespace Iridium
         bool Reset() override;
         bool Update() override;
 
+        usize DecodeAll(const u8* in, usize in_len, u8* out, usize out_len) override;
+
+        bool EnableCheckpoints() override;
+        Ptr<TransformCheckpoint> SaveCheckpoint() override;
+        bool RestoreCheckpoint(const TransformCheckpoint& checkpoint) override;
+
     private:
-        z_stream inflater_ {};
+        Ptr<z_stream> inflater_;
+
+        i32 window_bits_ {0};
+
+        // Stop after each deflate block, as those are the only places a checkpoint can be made
+        bool stop_at_blocks_ {false};
+
+        // Set when the last Update stopped at the end of a block
+        bool at_block_end_ {false};
     };
 
     class DeflateTransform : public BinaryTransform
@@ -29,6 +47,66 @@ namespace Iridium
         bool Update() override;
 
     private:
-        z_stream deflater_ {};
+        Ptr<z_stream> deflater_;
+
+        u32 cache_key_ {0};
+    };
+
+    // Produces a raw deflate stream by compressing blocks of the input on multiple threads
+    // Each block is primed with the 32KB before it, and ends on a byte boundary so the outputs can be joined
+    // Workers are started as blocks are queued, and compress each block while the following ones are gathered
+    // They live as long as the transform, so reuse it (after a Reset) when compressing many files
+    class ParallelDeflateTransform : public BinaryTransform
+    {
+    public:
+        // thread_count of 0 uses every hardware thread
+        ParallelDeflateTransform(i32 level = Z_BEST_COMPRESSION, i32 mem_level = MAX_MEM_LEVEL,
+            usize block_size = 0x20000, usize thread_count = 0);
+        ~ParallelDeflateTransform() override;
+
+        bool Reset() override;
+        bool Update() override;
+
+    private:
+        struct Block;
+        struct Deflater;
+
+        i32 level_ {0};
+        i32 mem_level_ {0};
+        usize block_size_ {0};
+        usize thread_count_ {0};
+
+        // The dictionary for the next block, followed by the input gathered for it
+        Vec<u8> input_;
+        usize dict_size_ {0};
+
+        // Blocks which have not been written out yet, in order
+        Vec<Ptr<Block>> blocks_;
+        usize output_pos_ {0};
+
+        // Set once the last block has been queued
+        bool done_ {false};
+
+        Vec<Ptr<Deflater>> deflaters_;
+        Vec<std::thread> workers_;
+
+        // Guards blocks_, and the state of each block
+        Mutex lock_;
+        ConditionVariable work_ready_;
+        ConditionVariable work_done_;
+        bool stopping_ {false};
+
+        // Queues the gathered input as the next block, ending the stream if last is set
+        bool QueueBlock(bool last);
+
+        void WaitForFirstBlock();
+
+        // Drops any blocks which have not been written out, waiting for those already being compressed
+        void CancelBlocks();
+
+        bool StartWorker();
+        void StopWorkers();
+
+        void RunWorker(Deflater& deflater);
     };
 } // namespace Iridium
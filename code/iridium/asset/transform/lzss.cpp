@@ -2,6 +2,78 @@
 
 namespace Iridium
 {
+    // Each group is a flag byte followed by 8 tokens, which are either a literal or a 2 byte match of up to 18 bytes
+    static constexpr usize LzssMaxGroupIn = 1 + 8 * 2;
+    static constexpr usize LzssMaxGroupOut = 8 * 18;
+
+    // Decodes whole groups straight into the output, for as long as there is room for a full group
+    // history is the ring window holding the output before out_start, with history_pos following its newest byte
+    static IR_FORCEINLINE void LzssDecodeGroups(const u8*& in, const u8* in_end, u8*& out, u8* const out_start,
+        u8* const out_end, const u8* history, u16fast history_pos)
+    {
+        // Matches are copied 8 bytes at a time, so can write up to 7 bytes past their end
+        while ((usize(in_end - in) >= LzssMaxGroupIn) && (usize(out_end - out) >= LzssMaxGroupOut + 8))
+        {
+            u8 flags = *in++;
+
+            for (usize i = 0; i < 8; ++i, flags >>= 1)
+            {
+                if (flags & 0x1)
+                {
+                    *out++ = *in++;
+
+                    continue;
+                }
+
+                usize len = (in[1] & 0xF) + 3;
+                usize dist = (usize(in[1] & 0xF0) << 4) | in[0];
+
+                in += 2;
+
+                // An offset of 0 refers to the byte a whole window back
+                if (dist == 0)
+                    dist = 0x1000;
+
+                if (usize(out - out_start) < dist)
+                {
+                    // Starts before this output, so at least some of it comes from the window
+                    for (; len; --len, ++out)
+                    {
+                        usize const written = usize(out - out_start);
+
+                        if (written >= dist)
+                            *out = out[-isize(dist)];
+                        else
+                            *out = history[(history_pos - (dist - written)) & 0xFFF];
+                    }
+                }
+                else if (dist >= 8)
+                {
+                    const u8* src = out - dist;
+                    u8* const end = out + len;
+
+                    do
+                    {
+                        std::memcpy(out, src, 8);
+
+                        out += 8;
+                        src += 8;
+                    } while (out < end);
+
+                    out = end;
+                }
+                else
+                {
+                    // Overlapping run, where each byte depends on one just written
+                    const u8* src = out - dist;
+
+                    for (; len; --len)
+                        *out++ = *src++;
+                }
+            }
+        }
+    }
+
     LzssTransform::LzssTransform()
     {
         Reset();
@@ -36,6 +108,18 @@ namespace Iridium
         {
             if ((format_ & 0x100) == 0)
             {
+                // Between groups, so switch to decoding straight into the output if there is room
+                if (pending_)
+                    FlushPending();
+
+                if (pending_ == 0)
+                {
+                    DecodeDirect();
+
+                    if (!AvailIn || !AvailOut)
+                        break;
+                }
+
                 format_ = 0xFF00 | u16(*NextIn++);
 
                 if (--AvailIn == 0)
@@ -93,6 +177,129 @@ namespace Iridium
         return true;
     }
 
+    struct LzssCheckpoint final : TransformCheckpoint
+    {
+        LzssTransform State;
+    };
+
+    bool LzssTransform::EnableCheckpoints()
+    {
+        return true;
+    }
+
+    Ptr<TransformCheckpoint> LzssTransform::SaveCheckpoint()
+    {
+        // The whole state is tiny, so it can be saved anywhere
+        Ptr<LzssCheckpoint> result = MakeUnique<LzssCheckpoint>();
+
+        result->Size = sizeof(LzssCheckpoint);
+        result->State = *this;
+
+        return result;
+    }
+
+    bool LzssTransform::RestoreCheckpoint(const TransformCheckpoint& checkpoint)
+    {
+        const LzssTransform& state = static_cast<const LzssCheckpoint&>(checkpoint).State;
+
+        format_ = state.format_;
+        buffered_ = state.buffered_;
+        std::memcpy(buffer_, state.buffer_, sizeof(buffer_));
+        current_ = state.current_;
+        pending_ = state.pending_;
+        std::memcpy(window_, state.window_, sizeof(window_));
+
+        Finished = false;
+
+        return true;
+    }
+
+    usize LzssTransform::DecodeAll(const u8* in, usize in_len, u8* out, usize out_len)
+    {
+        const u8* const in_end = in + in_len;
+
+        u8* here = out;
+        u8* const out_end = out + out_len;
+
+        Reset();
+
+        LzssDecodeGroups(in, in_end, here, out, out_end, window_, current_);
+
+        u16 format = 0;
+
+        // The whole output is available, so matches can copy straight from it instead of going through the window
+        while (here != out_end)
+        {
+            if ((format & 0x100) == 0)
+            {
+                if (in == in_end)
+                    break;
+
+                format = 0xFF00 | u16(*in++);
+            }
+
+            if (format & 0x1)
+            {
+                if (in == in_end)
+                    break;
+
+                *here++ = *in++;
+            }
+            else
+            {
+                if (in_end - in < 2)
+                    break;
+
+                usize len = std::min<usize>((in[1] & 0xF) + 3, out_end - here);
+                usize dist = (usize(in[1] & 0xF0) << 4) | in[0];
+
+                in += 2;
+
+                // An offset of 0 refers to the byte a whole window back
+                if (dist == 0)
+                    dist = 0x1000;
+
+                for (; len; --len, ++here)
+                    *here = (usize(here - out) >= dist) ? here[-isize(dist)] : 0x20;
+            }
+
+            format >>= 1;
+        }
+
+        return static_cast<usize>(here - out);
+    }
+
+    void LzssTransform::DecodeDirect()
+    {
+        const u8* in = NextIn;
+        u8* out = NextOut;
+
+        LzssDecodeGroups(in, NextIn + AvailIn, out, NextOut, NextOut + AvailOut, window_, current_);
+
+        usize const produced = usize(out - NextOut);
+
+        // Copy the tail of the output back into the window, for the slow path and the next call
+        usize const keep = std::min<usize>(produced, sizeof(window_));
+
+        for (usize done = 0; done < keep;)
+        {
+            usize const pos = (current_ + produced - keep + done) & 0xFFF;
+            usize const len = std::min<usize>(keep - done, sizeof(window_) - pos);
+
+            std::memcpy(&window_[pos], out - keep + done, len);
+
+            done += len;
+        }
+
+        current_ = u16fast(current_ + produced);
+
+        AvailIn -= usize(in - NextIn);
+        NextIn = in;
+
+        AvailOut -= produced;
+        NextOut = out;
+    }
+
     void LzssTransform::FlushPending()
     {
         while (pending_ && AvailOut)
@@ -114,4 +321,233 @@ namespace Iridium
             pending_ -= len;
         }
     }
+
+    static constexpr usize LzssMinMatch = 3;
+    static constexpr usize LzssMaxMatch = 18;
+    static constexpr usize LzssMaxDist = 0xFFF;
+
+    LzssEncodeTransform::LzssEncodeTransform(u32 max_chain)
+        : max_chain_(std::max<u32>(max_chain, 1))
+        , buffer_(BufferSize)
+        , head_(HashSize)
+        , prev_(BufferSize)
+    {
+        Reset();
+    }
+
+    bool LzssEncodeTransform::Reset()
+    {
+        Finished = false;
+
+        // The decoder's window starts out full of spaces, so they can be matched before any input has been seen
+        std::memset(buffer_.data(), 0x20, HistorySize);
+
+        pos_ = HistorySize;
+        end_ = HistorySize;
+
+        std::fill(head_.begin(), head_.end(), -1);
+
+        for (usize i = 0; i + LzssMinMatch <= HistorySize; ++i)
+            InsertHash(i);
+
+        checksum_ = 0;
+        done_ = false;
+
+        group_len_ = 0;
+        group_count_ = 0;
+
+        staged_pos_ = 0;
+        staged_len_ = 0;
+
+        return true;
+    }
+
+    bool LzssEncodeTransform::Update()
+    {
+        while (true)
+        {
+            if (staged_pos_ != staged_len_)
+            {
+                usize const len = std::min<usize>(staged_len_ - staged_pos_, AvailOut);
+
+                std::memcpy(NextOut, &staged_[staged_pos_], len);
+
+                NextOut += len;
+                AvailOut -= len;
+                staged_pos_ += u8(len);
+
+                if (staged_pos_ != staged_len_)
+                    return true;
+            }
+
+            if (done_)
+                return true;
+
+            usize const avail = end_ - pos_;
+
+            // Only encode once a full match could be seen, unless there is no more input coming
+            if ((avail >= LzssMaxMatch) || (Finished && !AvailIn && avail))
+            {
+                EncodeToken();
+
+                continue;
+            }
+
+            if (AvailIn)
+            {
+                Fill();
+
+                continue;
+            }
+
+            if (!Finished)
+                return true;
+
+            staged_pos_ = 0;
+            staged_len_ = 0;
+
+            if (group_count_)
+                StageGroup();
+
+            for (usize i = 0; i < 4; ++i)
+                staged_[staged_len_++] = u8(checksum_ >> (i * 8));
+
+            done_ = true;
+        }
+    }
+
+    void LzssEncodeTransform::Fill()
+    {
+        if (end_ == BufferSize)
+            Slide();
+
+        usize const len = std::min<usize>(AvailIn, BufferSize - end_);
+
+        for (usize i = 0; i < len; ++i)
+            checksum_ += NextIn[i];
+
+        std::memcpy(&buffer_[end_], NextIn, len);
+
+        NextIn += len;
+        AvailIn -= len;
+        end_ += len;
+    }
+
+    void LzssEncodeTransform::Slide()
+    {
+        // Keep just enough history behind the current position for any match
+        usize const shift = pos_ - HistorySize;
+
+        if (shift == 0)
+            return;
+
+        std::memmove(&buffer_[0], &buffer_[shift], end_ - shift);
+        std::memmove(&prev_[0], &prev_[shift], (end_ - shift) * sizeof(i32));
+
+        pos_ -= shift;
+        end_ -= shift;
+
+        auto const rebase = [shift](i32& value) {
+            value = (value >= i32(shift)) ? (value - i32(shift)) : -1;
+        };
+
+        std::for_each(head_.begin(), head_.end(), rebase);
+        std::for_each(prev_.begin(), prev_.begin() + end_, rebase);
+    }
+
+    void LzssEncodeTransform::InsertHash(usize pos)
+    {
+        const u8* data = &buffer_[pos];
+
+        usize const hash = ((usize(data[0]) << 8) ^ (usize(data[1]) << 4) ^ data[2]) & (HashSize - 1);
+
+        prev_[pos] = head_[hash];
+        head_[hash] = i32(pos);
+    }
+
+    void LzssEncodeTransform::EncodeToken()
+    {
+        usize const avail = std::min<usize>(end_ - pos_, LzssMaxMatch);
+
+        usize best_len = 0;
+        usize best_dist = 0;
+
+        if (avail >= LzssMinMatch)
+        {
+            const u8* const here = &buffer_[pos_];
+
+            usize const hash = ((usize(here[0]) << 8) ^ (usize(here[1]) << 4) ^ here[2]) & (HashSize - 1);
+
+            i32 candidate = head_[hash];
+
+            for (u32 chain = max_chain_; (candidate >= 0) && chain; --chain)
+            {
+                usize const dist = pos_ - usize(candidate);
+
+                if (dist > LzssMaxDist)
+                    break;
+
+                const u8* const there = &buffer_[candidate];
+
+                // Only worth comparing if it could beat the best match so far
+                if (there[best_len] == here[best_len])
+                {
+                    usize len = 0;
+
+                    while ((len < avail) && (there[len] == here[len]))
+                        ++len;
+
+                    if (len > best_len)
+                    {
+                        best_len = len;
+                        best_dist = dist;
+
+                        if (len == avail)
+                            break;
+                    }
+                }
+
+                candidate = prev_[candidate];
+            }
+        }
+
+        if (group_count_ == 0)
+        {
+            group_[0] = 0;
+            group_len_ = 1;
+        }
+
+        if (best_len >= LzssMinMatch)
+        {
+            group_[group_len_++] = u8(best_dist);
+            group_[group_len_++] = u8(((best_dist >> 4) & 0xF0) | (best_len - LzssMinMatch));
+        }
+        else
+        {
+            group_[0] |= u8(1 << group_count_);
+            group_[group_len_++] = buffer_[pos_];
+
+            best_len = 1;
+        }
+
+        for (usize const end = pos_ + best_len; pos_ < end; ++pos_)
+        {
+            if (pos_ + LzssMinMatch <= end_)
+                InsertHash(pos_);
+        }
+
+        if (++group_count_ == 8)
+            StageGroup();
+    }
+
+    void LzssEncodeTransform::StageGroup()
+    {
+        std::memcpy(staged_, group_, group_len_);
+
+        staged_pos_ = 0;
+        staged_len_ = group_len_;
+
+        group_len_ = 0;
+        group_count_ = 0;
+    }
 } // namespace Iridium
@@ -12,6 +12,12 @@ namespace Iridium
         bool Reset() override;
         bool Update() override;
 
+        usize DecodeAll(const u8* in, usize in_len, u8* out, usize out_len) override;
+
+        bool EnableCheckpoints() override;
+        Ptr<TransformCheckpoint> SaveCheckpoint() override;
+        bool RestoreCheckpoint(const TransformCheckpoint& checkpoint) override;
+
     private:
         u16 format_ {0};
 
@@ -23,5 +29,56 @@ namespace Iridium
         u8 window_[0x1000];
 
         void FlushPending();
+
+        // Decodes as much as possible straight into NextOut, bypassing the window
+        void DecodeDirect();
+    };
+
+    // Encodes the same format, finding matches through hash chains
+    // The output ends with a 32-bit sum of the input bytes, as expected by PBO archives
+    class LzssEncodeTransform : public BinaryTransform
+    {
+    public:
+        // max_chain is how many earlier matches are tried at each position
+        // Higher values compress better but slower, with 1 being fastest
+        LzssEncodeTransform(u32 max_chain = 64);
+
+        bool Reset() override;
+        bool Update() override;
+
+    private:
+        static constexpr usize HistorySize = 0x1000;
+        static constexpr usize BufferSize = HistorySize + 0x10000;
+        static constexpr usize HashSize = 0x4000;
+
+        u32 max_chain_ {0};
+
+        // Input being encoded, starting with the previous window
+        Vec<u8> buffer_;
+        usize pos_ {0};
+        usize end_ {0};
+
+        // Most recent position of each hash, and the previous position with the same hash
+        Vec<i32> head_;
+        Vec<i32> prev_;
+
+        u32 checksum_ {0};
+        bool done_ {false};
+
+        // The group being built, and encoded bytes still waiting for room in the output
+        u8 group_[1 + 8 * 2];
+        u8 group_len_ {0};
+        u8 group_count_ {0};
+
+        u8 staged_[1 + 8 * 2 + 4];
+        u8 staged_pos_ {0};
+        u8 staged_len_ {0};
+
+        void Fill();
+        void Slide();
+
+        void InsertHash(usize pos);
+        void EncodeToken();
+        void StageGroup();
     };
 } // namespace Iridium
@@ -0,0 +1,121 @@
+#include "zstd.h"
+
+namespace Iridium
+{
+    ZstdTransform::ZstdTransform()
+        : decoder_(ZSTD_createDCtx())
+    {}
+
+    ZstdTransform::~ZstdTransform()
+    {
+        ZSTD_freeDCtx(decoder_);
+    }
+
+    bool ZstdTransform::Reset()
+    {
+        Finished = false;
+
+        return !ZSTD_isError(ZSTD_DCtx_reset(decoder_, ZSTD_reset_session_only));
+    }
+
+    bool ZstdTransform::Update()
+    {
+        bool progress = false;
+
+        while (AvailOut)
+        {
+            ZSTD_inBuffer input {NextIn, AvailIn, 0};
+            ZSTD_outBuffer output {NextOut, AvailOut, 0};
+
+            usize const result = ZSTD_decompressStream(decoder_, &output, &input);
+
+            NextIn += input.pos;
+            AvailIn -= input.pos;
+
+            NextOut += output.pos;
+            AvailOut -= output.pos;
+
+            if (ZSTD_isError(result))
+                return false;
+
+            if (result == 0)
+            {
+                Finished = true;
+
+                break;
+            }
+
+            // Out of input, with everything decoded so far already flushed
+            if ((input.pos == 0) && (output.pos == 0))
+                return progress;
+
+            progress = true;
+        }
+
+        return true;
+    }
+
+    usize ZstdTransform::DecodeAll(const u8* in, usize in_len, u8* out, usize out_len)
+    {
+        if (!Reset())
+            return 0;
+
+        // Decoding the whole frame in one go writes straight into out, but only works if all of it fits
+        usize const result = ZSTD_decompressDCtx(decoder_, out, out_len, in, in_len);
+
+        if (!ZSTD_isError(result))
+        {
+            Finished = true;
+
+            return result;
+        }
+
+        return BinaryTransform::DecodeAll(in, in_len, out, out_len);
+    }
+
+    ZstdEncodeTransform::ZstdEncodeTransform(i32 level)
+        : encoder_(ZSTD_createCCtx())
+    {
+        ZSTD_CCtx_setParameter(encoder_, ZSTD_c_compressionLevel, level);
+    }
+
+    ZstdEncodeTransform::~ZstdEncodeTransform()
+    {
+        ZSTD_freeCCtx(encoder_);
+    }
+
+    bool ZstdEncodeTransform::Reset()
+    {
+        Finished = false;
+        done_ = false;
+
+        return !ZSTD_isError(ZSTD_CCtx_reset(encoder_, ZSTD_reset_session_only));
+    }
+
+    bool ZstdEncodeTransform::Update()
+    {
+        while ((AvailIn || (Finished && !done_)) && AvailOut)
+        {
+            ZSTD_inBuffer input {NextIn, AvailIn, 0};
+            ZSTD_outBuffer output {NextOut, AvailOut, 0};
+
+            usize const remaining =
+                ZSTD_compressStream2(encoder_, &output, &input, Finished ? ZSTD_e_end : ZSTD_e_continue);
+
+            NextIn += input.pos;
+            AvailIn -= input.pos;
+
+            NextOut += output.pos;
+            AvailOut -= output.pos;
+
+            if (ZSTD_isError(remaining))
+                return false;
+
+            // Another call with ZSTD_e_end would start a new frame
+            if (Finished && (remaining == 0))
+                done_ = true;
+        }
+
+        return true;
+    }
+} // namespace Iridium
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "asset/transform.h"
+
+#include <zstd.h>
+
+namespace Iridium
+{
+    class ZstdTransform : public BinaryTransform
+    {
+    public:
+        ZstdTransform();
+        ~ZstdTransform() override;
+
+        bool Reset() override;
+        bool Update() override;
+
+        usize DecodeAll(const u8* in, usize in_len, u8* out, usize out_len) override;
+
+    private:
+        ZSTD_DCtx* decoder_ {nullptr};
+    };
+
+    class ZstdEncodeTransform : public BinaryTransform
+    {
+    public:
+        ZstdEncodeTransform(i32 level = ZSTD_CLEVEL_DEFAULT);
+        ~ZstdEncodeTransform() override;
+
+        bool Reset() override;
+        bool Update() override;
+
+    private:
+        ZSTD_CCtx* encoder_ {nullptr};
+
+        // Set once the frame has been completely written
+        bool done_ {false};
+    };
+} // namespace Iridium
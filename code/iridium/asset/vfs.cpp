@@ -283,6 +283,61 @@ namespace Iridium
         return success;
     }
 
+    bool VFS::Delete(StringView path)
+    {
+        if (Locked())
+            return false;
+
+        FileNode* node = GetFile(path);
+
+        if (node == nullptr)
+            return false;
+
+        node->ParentFolder->RemoveNode(node);
+        HashUnlinkNode(node);
+
+        FreeNode(node);
+
+        return true;
+    }
+
+    bool VFS::DeleteFolder(StringView path)
+    {
+        if (Locked())
+            return false;
+
+        FolderNode* folder = GetFolder(path, false);
+
+        // The root folder has no parent to be removed from, use Clear instead
+        if (folder == nullptr || folder->ParentFolder == nullptr)
+            return false;
+
+        folder->ParentFolder->RemoveNode(folder);
+
+        FreeFolderTree(folder);
+
+        return true;
+    }
+
+    void VFS::FreeFolderTree(FolderNode* folder)
+    {
+        for (Node *n = folder->EntriesHead, *next = nullptr; n; n = next)
+        {
+            next = n->FolderNext;
+
+            HashUnlinkNode(n);
+
+            if (n->IsFolder)
+                FreeFolderTree(static_cast<FolderNode*>(n));
+            else
+                FreeNode(n);
+        }
+
+        HashUnlinkNode(folder);
+
+        FreeNode(folder);
+    }
+
     const u32 VFS::HashPathLookup[256] {
         // Fractional part of pi, with normalized case
         // clang-format off
@@ -42,6 +42,12 @@ namespace Iridium
 
         bool Rename(StringView old_name, StringView new_name, bool create);
 
+        // Removes a file
+        bool Delete(StringView path);
+
+        // Removes a folder (path ending with a slash), and everything inside of it
+        bool DeleteFolder(StringView path);
+
         Ptr<FindFileHandle> Find(StringView path);
 
         template <typename T, typename... Args>
@@ -75,6 +81,8 @@ namespace Iridium
         void HashUnlinkNode(Node* node);
         void HashReplaceNode(Node* old_node, Node* new_node);
 
+        void FreeFolderTree(FolderNode* folder);
+
         Rc<Stream> ConvertToTempNode(FileNode* node, bool truncate);
 
         template <typename T, typename... Args>
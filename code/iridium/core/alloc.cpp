@@ -2,13 +2,121 @@
 
 namespace Iridium
 {
+    // zlib allocates the same few sizes (state, window, hash chains) for every stream
+    // Freed blocks are kept per thread and handed out again, instead of going back to malloc each time
+    struct ZlibBlockCache
+    {
+        static constexpr usize MaxBlocks = 32;
+        static constexpr usize MaxBlockSize = 0x40000;
+        static constexpr usize MaxTotalSize = 0x200000;
+
+        usize Sizes[MaxBlocks];
+        void* Blocks[MaxBlocks];
+
+        usize Count;
+        usize TotalSize;
+
+        bool Registered;
+        bool Enabled;
+    };
+
+    // Trivially destructible, so it can still be used by other thread_local destructors which free zlib streams
+    static thread_local ZlibBlockCache ZlibBlocks {};
+
+    // Frees the cached blocks when the thread exits, after which blocks go straight back to malloc
+    struct ZlibBlockCacheOwner
+    {
+        ZlibBlockCacheOwner()
+        {
+            ZlibBlocks.Enabled = true;
+        }
+
+        ~ZlibBlockCacheOwner()
+        {
+            ZlibBlockCache& cache = ZlibBlocks;
+
+            for (usize i = 0; i < cache.Count; ++i)
+                std::free(cache.Blocks[i]);
+
+            cache.Count = 0;
+            cache.TotalSize = 0;
+            cache.Enabled = false;
+        }
+    };
+
+    static thread_local ZlibBlockCacheOwner ZlibBlocksOwner;
+
+    static ZlibBlockCache* GetZlibBlockCache()
+    {
+        ZlibBlockCache& cache = ZlibBlocks;
+
+        if (!cache.Registered)
+        {
+            cache.Registered = true;
+
+            // Constructs the owner on first use
+            static_cast<void>(ZlibBlocksOwner);
+        }
+
+        return cache.Enabled ? &cache : nullptr;
+    }
+
+    // Stores the size of each block in front of it, as zfree is not told the size
+    // Padded to keep the block as aligned as malloc made it
+    static constexpr usize ZlibBlockHeader = 16;
+
     void* Z_alloc([[maybe_unused]] void* opaque, unsigned int items, unsigned int size)
     {
-        return std::malloc(size * items);
+        usize const length = usize(size) * items;
+
+        if (ZlibBlockCache* cache = GetZlibBlockCache())
+        {
+            // Most recently freed first, as it is the most likely to still be in the CPU cache
+            for (usize i = cache->Count; i--;)
+            {
+                if (cache->Sizes[i] == length)
+                {
+                    void* const block = cache->Blocks[i];
+
+                    --cache->Count;
+                    cache->TotalSize -= length;
+
+                    cache->Sizes[i] = cache->Sizes[cache->Count];
+                    cache->Blocks[i] = cache->Blocks[cache->Count];
+
+                    return static_cast<u8*>(block) + ZlibBlockHeader;
+                }
+            }
+        }
+
+        void* const block = std::malloc(length + ZlibBlockHeader);
+
+        if (block == nullptr)
+            return nullptr;
+
+        *static_cast<usize*>(block) = length;
+
+        return static_cast<u8*>(block) + ZlibBlockHeader;
     }
 
     void Z_free([[maybe_unused]] void* opaque, void* address)
     {
-        return std::free(address);
+        if (address == nullptr)
+            return;
+
+        void* const block = static_cast<u8*>(address) - ZlibBlockHeader;
+        usize const length = *static_cast<usize*>(block);
+
+        ZlibBlockCache* cache = GetZlibBlockCache();
+
+        if ((cache == nullptr) || (cache->Count == ZlibBlockCache::MaxBlocks) ||
+            (length > ZlibBlockCache::MaxBlockSize) || (cache->TotalSize + length > ZlibBlockCache::MaxTotalSize))
+            return std::free(block);
+
+        cache->Sizes[cache->Count] = length;
+        cache->Blocks[cache->Count] = block;
+
+        ++cache->Count;
+        cache->TotalSize += length;
     }
 } // namespace Iridium
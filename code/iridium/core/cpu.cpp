@@ -0,0 +1,77 @@
+#include "cpu.h"
+
+#if IR_ARCH_X86
+#    ifdef _MSC_VER
+#        include <intrin.h>
+#    else
+#        include <cpuid.h>
+#    endif
+#endif
+
+namespace Iridium
+{
+#if IR_ARCH_X86
+    static void CpuId(u32 leaf, u32 subleaf, u32 regs[4])
+    {
+#    ifdef _MSC_VER
+        int info[4];
+        __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+        std::memcpy(regs, info, sizeof(info));
+#    else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#    endif
+    }
+
+    static u64 GetXCR0()
+    {
+#    ifdef _MSC_VER
+        return _xgetbv(0);
+#    else
+        u32 eax, edx;
+        __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return eax | (u64(edx) << 32);
+#    endif
+    }
+
+    static CpuFeatures DetectCpuFeatures()
+    {
+        CpuFeatures result;
+
+        u32 regs[4];
+
+        CpuId(0, 0, regs);
+        u32 const max_leaf = regs[0];
+
+        if (max_leaf < 1)
+            return result;
+
+        CpuId(1, 0, regs);
+
+        result.AES = regs[2] & (1 << 25);
+
+        // AVX also needs the OS to save the YMM registers (OSXSAVE, then XCR0 bits 1 and 2)
+        bool const has_avx = (regs[2] & (1 << 27)) && (regs[2] & (1 << 28)) && ((GetXCR0() & 0x6) == 0x6);
+
+        if (max_leaf >= 7)
+        {
+            CpuId(7, 0, regs);
+
+            result.AVX2 = has_avx && (regs[1] & (1 << 5));
+            result.VAES = result.AES && result.AVX2 && (regs[2] & (1 << 9));
+        }
+
+        return result;
+    }
+#endif
+
+    const CpuFeatures& GetCpuFeatures()
+    {
+#if IR_ARCH_X86
+        static const CpuFeatures features = DetectCpuFeatures();
+#else
+        static const CpuFeatures features {};
+#endif
+
+        return features;
+    }
+} // namespace Iridium
@@ -0,0 +1,14 @@
+#pragma once
+
+namespace Iridium
+{
+    // Instruction set extensions which are usable, both supported by the CPU and enabled by the OS
+    struct CpuFeatures
+    {
+        bool AES {false};
+        bool AVX2 {false};
+        bool VAES {false};
+    };
+
+    const CpuFeatures& GetCpuFeatures();
+} // namespace Iridium
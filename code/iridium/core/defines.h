@@ -32,3 +32,17 @@
 #ifndef IR_LINE
 #    define IR_LINE IR_CONCAT(__LINE__, L) // Workaround Edit and Continue
 #endif
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#    define IR_ARCH_X86 1
+#else
+#    define IR_ARCH_X86 0
+#endif
+
+// Allows a function to use instructions beyond the baseline. Check GetCpuFeatures before calling it.
+// MSVC allows intrinsics anywhere, so it needs no annotation
+#if defined(__GNUC__) || defined(__clang__)
+#    define IR_TARGET(FEATURES) __attribute__((target(FEATURES)))
+#else
+#    define IR_TARGET(FEATURES)
+#endif
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <condition_variable>
 #include <mutex>
 
 namespace Iridium
@@ -13,4 +14,6 @@ namespace Iridium
     using UniqueLock = std::unique_lock<T>;
 
     using MutexGuard = LockGuard<Mutex>;
+
+    using ConditionVariable = std::condition_variable;
 } // namespace Iridium
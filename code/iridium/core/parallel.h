@@ -44,6 +44,21 @@ inline size_t parallel_get_thread_count()
     return result;
 }
 
+// Calls func(thread_index, index) for every index below count, using up to thread_count threads
+// Each thread takes the next index not yet started, so items of uneven cost still keep every thread busy
+template <typename BinaryFunction>
+inline void parallel_for_n(size_t count, size_t thread_count, const BinaryFunction& func)
+{
+    std::atomic_size_t next {0};
+
+    return parallel_invoke_n(std::min<size_t>(thread_count, count), [&](size_t thread_index) {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;)
+        {
+            func(thread_index, i);
+        }
+    });
+}
+
 template <typename ForwardIt, typename UnaryPredicate>
 inline void parallel_for_each(ForwardIt first, ForwardIt last, const UnaryPredicate& func)
 {
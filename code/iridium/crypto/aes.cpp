@@ -1,23 +1,217 @@
 #include "aes.h"
 
+#include "core/cpu.h"
+
+#if IR_ARCH_X86
+#    include <immintrin.h>
+#endif
+
 namespace Iridium
 {
+#if IR_ARCH_X86
+    IR_TARGET("aes")
+    static u32 AESNI_SubWord(u32 word)
+    {
+        // aeskeygenassist applies SubWord to the second word
+        return static_cast<u32>(
+            _mm_cvtsi128_si32(_mm_aeskeygenassist_si128(_mm_set_epi32(0, 0, static_cast<int>(word), 0), 0)));
+    }
+
+    IR_TARGET("aes")
+    static void AESNI_ExpandKey(const u8* key, usize key_length, bool decrypt, u8 round_keys[15][16], u32& rounds)
+    {
+        u32 const key_words = static_cast<u32>(key_length / 4);
+
+        rounds = key_words + 6;
+
+        u32 words[15 * 4];
+        std::memcpy(words, key, key_length);
+
+        u32 rcon = 0x01;
+
+        for (u32 i = key_words; i < 4 * (rounds + 1); ++i)
+        {
+            u32 temp = words[i - 1];
+
+            if (i % key_words == 0)
+            {
+                // RotWord is a rotate right, as the first byte is the lowest
+                temp = AESNI_SubWord(temp);
+                temp = ((temp >> 8) | (temp << 24)) ^ rcon;
+
+                rcon = ((rcon << 1) ^ ((rcon & 0x80) ? 0x1B : 0)) & 0xFF;
+            }
+            else if ((key_words > 6) && (i % key_words == 4))
+            {
+                temp = AESNI_SubWord(temp);
+            }
+
+            words[i] = words[i - key_words] ^ temp;
+        }
+
+        if (!decrypt)
+        {
+            std::memcpy(round_keys, words, 16 * (rounds + 1));
+
+            return;
+        }
+
+        // The equivalent inverse cipher uses the keys in reverse, with InvMixColumns applied to the inner ones
+        const __m128i* keys = reinterpret_cast<const __m128i*>(words);
+
+        for (u32 i = 0; i <= rounds; ++i)
+        {
+            __m128i round_key = _mm_loadu_si128(&keys[rounds - i]);
+
+            if ((i != 0) && (i != rounds))
+                round_key = _mm_aesimc_si128(round_key);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(round_keys[i]), round_key);
+        }
+    }
+
+    // Several blocks are processed together to hide the latency of each round
+    template <bool Decrypt, usize N>
+    IR_TARGET("aes")
+    static IR_FORCEINLINE void AESNI_ProcessBlocks(__m128i (&data)[N], const __m128i* keys, u32 rounds)
+    {
+        for (usize j = 0; j < N; ++j)
+            data[j] = _mm_xor_si128(data[j], keys[0]);
+
+        for (u32 i = 1; i < rounds; ++i)
+        {
+            __m128i const key = keys[i];
+
+            for (usize j = 0; j < N; ++j)
+                data[j] = Decrypt ? _mm_aesdec_si128(data[j], key) : _mm_aesenc_si128(data[j], key);
+        }
+
+        __m128i const last_key = keys[rounds];
+
+        for (usize j = 0; j < N; ++j)
+            data[j] = Decrypt ? _mm_aesdeclast_si128(data[j], last_key) : _mm_aesenclast_si128(data[j], last_key);
+    }
+
+    template <bool Decrypt>
+    IR_TARGET("aes")
+    static void AESNI_Ecb(const u8 round_keys[15][16], u32 rounds, const u8* input, u8* output, usize blocks)
+    {
+        const __m128i* keys = reinterpret_cast<const __m128i*>(round_keys);
+
+        for (; blocks >= 8; blocks -= 8, input += 128, output += 128)
+        {
+            __m128i data[8];
+
+            for (usize j = 0; j < 8; ++j)
+                data[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 16 * j));
+
+            AESNI_ProcessBlocks<Decrypt>(data, keys, rounds);
+
+            for (usize j = 0; j < 8; ++j)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 16 * j), data[j]);
+        }
+
+        for (; blocks; --blocks, input += 16, output += 16)
+        {
+            __m128i data[1] {_mm_loadu_si128(reinterpret_cast<const __m128i*>(input))};
+
+            AESNI_ProcessBlocks<Decrypt>(data, keys, rounds);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output), data[0]);
+        }
+    }
+
+    // VAES does the same with 2 blocks per register
+    template <bool Decrypt>
+    IR_TARGET("aes,vaes,avx2")
+    static void VAES_Ecb(const u8 round_keys[15][16], u32 rounds, const u8* input, u8* output, usize blocks)
+    {
+        __m256i keys[15];
+
+        for (u32 i = 0; i <= rounds; ++i)
+            keys[i] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(round_keys[i])));
+
+        for (; blocks >= 16; blocks -= 16, input += 256, output += 256)
+        {
+            __m256i data[8];
+
+            for (usize j = 0; j < 8; ++j)
+            {
+                data[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + 32 * j));
+                data[j] = _mm256_xor_si256(data[j], keys[0]);
+            }
+
+            for (u32 i = 1; i < rounds; ++i)
+            {
+                __m256i const key = keys[i];
+
+                for (usize j = 0; j < 8; ++j)
+                    data[j] = Decrypt ? _mm256_aesdec_epi128(data[j], key) : _mm256_aesenc_epi128(data[j], key);
+            }
+
+            for (usize j = 0; j < 8; ++j)
+            {
+                data[j] = Decrypt ? _mm256_aesdeclast_epi128(data[j], keys[rounds])
+                                  : _mm256_aesenclast_epi128(data[j], keys[rounds]);
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + 32 * j), data[j]);
+            }
+        }
+
+        AESNI_Ecb<Decrypt>(round_keys, rounds, input, output, blocks);
+    }
+#endif
+
     AesEcbCipher::AesEcbCipher(const u8* key, usize key_length, bool decrypt)
         : decrypt_(decrypt)
     {
         IrAssert(wc_AesSetKey(&ctx_, key, static_cast<word32>(key_length), nullptr,
                      decrypt ? AES_DECRYPTION : AES_ENCRYPTION) == 0,
             "Failed to set key");
+
+#if IR_ARCH_X86
+        const CpuFeatures& cpu = GetCpuFeatures();
+
+        if (cpu.AES && ((key_length == 16) || (key_length == 24) || (key_length == 32)))
+        {
+            AESNI_ExpandKey(key, key_length, decrypt, round_keys_, rounds_);
+
+            if (cpu.VAES)
+                hardware_ = decrypt ? VAES_Ecb<true> : VAES_Ecb<false>;
+            else
+                hardware_ = decrypt ? AESNI_Ecb<true> : AESNI_Ecb<false>;
+        }
+#endif
     }
 
     usize AesEcbCipher::Update(const u8* input, u8* output, usize length)
     {
+        if (hardware_)
+        {
+            hardware_(round_keys_, rounds_, input, output, length / AES_BLOCK_SIZE);
+
+            return length;
+        }
+
         return ((decrypt_ ? wc_AesEcbDecrypt : wc_AesEcbEncrypt)(&ctx_, output, input, static_cast<word32>(length)) ==
                    0)
             ? length
             : 0;
     }
 
+    usize AesEcbCipher::UpdateParallel(const u8* input, u8* output, usize length)
+    {
+        // ECB only reads the key schedule, so the ranges can share it
+        auto update = [&](usize offset, usize range_length) {
+            Update(input + offset, output + offset, range_length);
+        };
+
+        if (!ParallelCipherUpdate(length, AES_BLOCK_SIZE, update))
+            return Update(input, output, length);
+
+        return length;
+    }
+
     usize AesEcbCipher::GetBlockSize()
     {
         return AES_BLOCK_SIZE;
@@ -12,10 +12,21 @@ namespace Iridium
         AesEcbCipher(const u8* key, usize key_length, bool decrypt);
 
         usize Update(const u8* input, u8* output, usize length) override;
+        usize UpdateParallel(const u8* input, u8* output, usize length) override;
 
         usize GetBlockSize() override;
 
         Aes ctx_ {};
         bool decrypt_ {false};
+
+        // Used instead of ctx_ when the CPU supports AES instructions, chosen when the key is set
+        using HardwareFunc =
+            void (*)(const u8 round_keys[15][16], u32 rounds, const u8* input, u8* output, usize blocks);
+
+        HardwareFunc hardware_ {nullptr};
+
+        // Expanded key, in the order it is used (already inverted for decryption)
+        alignas(16) u8 round_keys_[15][16] {};
+        u32 rounds_ {0};
     };
 } // namespace Iridium
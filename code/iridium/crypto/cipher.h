@@ -1,5 +1,7 @@
 #pragma once
 
+#include "core/parallel.h"
+
 namespace Iridium
 {
     class Cipher
@@ -11,11 +13,129 @@ namespace Iridium
         // input may equal output, otherwise input must not overlap with output
         virtual usize Update(const u8* input, u8* output, usize length) = 0;
 
+        // Same as Update, but large inputs may be split across multiple threads
+        // Only ciphers whose blocks can be processed out of order (ECB, or CBC decryption) override this
+        virtual usize UpdateParallel(const u8* input, u8* output, usize length)
+        {
+            return Update(input, output, length);
+        }
+
         virtual usize GetBlockSize() = 0;
 
         inline usize Update(void* data, usize length)
         {
             return Update(static_cast<const u8*>(data), static_cast<u8*>(data), length);
         }
+
+        inline usize UpdateParallel(void* data, usize length)
+        {
+            return UpdateParallel(static_cast<const u8*>(data), static_cast<u8*>(data), length);
+        }
     };
+
+    // Smallest range worth giving to another thread
+    constexpr usize ParallelCipherMinRange = 0x20000;
+
+    // Size of the ranges to split length bytes into, or 0 if it isn't worth splitting
+    inline usize GetParallelCipherRange(usize length, usize block_size)
+    {
+        usize const ranges = std::min<usize>(parallel_get_thread_count(), length / ParallelCipherMinRange);
+
+        if (ranges < 2)
+            return 0;
+
+        usize const range = (length + ranges - 1) / ranges;
+
+        return (range + block_size - 1) / block_size * block_size;
+    }
+
+    // Calls func(offset, length) for ranges of whole blocks, on multiple threads
+    // Returns false (without calling func) if length is too small for it to be worthwhile
+    template <typename Func>
+    inline bool ParallelCipherUpdate(usize length, usize block_size, const Func& func)
+    {
+        usize const range = GetParallelCipherRange(length, block_size);
+
+        if (range == 0)
+            return false;
+
+        parallel_partition(length / block_size * block_size, range, 0, [&func](usize offset, usize size) {
+            func(offset, size);
+
+            return true;
+        });
+
+        return true;
+    }
+
+    // Decrypts a range serially, updating iv
+    // decrypt_blocks(input, output, count) decrypts whole blocks independently, as only the XOR with the previous
+    // block is chained, so blocks are decrypted in batches
+    template <usize BlockSize, typename Func>
+    inline void BatchedCbcDecrypt(const u8* input, u8* output, usize length, u8* iv, const Func& decrypt_blocks)
+    {
+        constexpr usize BatchBlocks = 16;
+
+        u8 temp[BatchBlocks * BlockSize];
+
+        for (usize blocks = length / BlockSize; blocks;)
+        {
+            usize const batch = std::min(blocks, BatchBlocks);
+            usize const batch_size = batch * BlockSize;
+
+            decrypt_blocks(input, temp, batch);
+
+            // Read all of the ciphertext before writing, as input may equal output
+            for (usize j = 0; j < BlockSize; ++j)
+                temp[j] ^= iv[j];
+
+            for (usize j = BlockSize; j < batch_size; ++j)
+                temp[j] ^= input[j - BlockSize];
+
+            std::memcpy(iv, input + batch_size - BlockSize, BlockSize);
+            std::memcpy(output, temp, batch_size);
+
+            blocks -= batch;
+            input += batch_size;
+            output += batch_size;
+        }
+    }
+
+    // CBC decryption of each block only needs the ciphertext block before it, so ranges can be decrypted separately
+    // decrypt(input, output, length, iv) decrypts a range serially, updating iv
+    template <usize BlockSize, typename Func>
+    inline bool ParallelCbcDecrypt(const u8* input, u8* output, usize length, u8 (&iv)[BlockSize], const Func& decrypt)
+    {
+        usize const range = GetParallelCipherRange(length, BlockSize);
+
+        if (range == 0)
+            return false;
+
+        length = length / BlockSize * BlockSize;
+
+        // Updating in place overwrites the ciphertext, so take the IV of each range (and the next IV) beforehand
+        usize const ranges = (length + range - 1) / range;
+
+        Vec<u8> ivs((ranges + 1) * BlockSize);
+
+        std::memcpy(&ivs[0], iv, BlockSize);
+
+        for (usize i = 1; i < ranges; ++i)
+            std::memcpy(&ivs[i * BlockSize], input + (i * range) - BlockSize, BlockSize);
+
+        std::memcpy(&ivs[ranges * BlockSize], input + length - BlockSize, BlockSize);
+
+        parallel_partition(length, range, 0, [&](usize offset, usize size) {
+            u8 range_iv[BlockSize];
+            std::memcpy(range_iv, &ivs[offset / range * BlockSize], BlockSize);
+
+            decrypt(input + offset, output + offset, size, range_iv);
+
+            return true;
+        });
+
+        std::memcpy(iv, &ivs[ranges * BlockSize], BlockSize);
+
+        return true;
+    }
 } // namespace Iridium
@@ -15,24 +15,26 @@ namespace Iridium
 
     EcbCipherStream::~EcbCipherStream() = default;
 
-    StreamPosition EcbCipherStream::Seek(i64 offset, SeekWhence whence)
+    i64 EcbCipherStream::Seek(i64 offset, SeekWhence whence)
     {
-        StreamPosition result = input_->Seek(offset, whence);
+        i64 const result = input_->Seek(offset, whence);
 
         buffered_ = 0;
 
-        if (result.valid())
-            padding_ = result.get() & (block_size_ - 1);
+        if (result >= 0)
+            padding_ = static_cast<usize>(result) & (block_size_ - 1);
 
         return result;
     }
 
-    StreamPosition EcbCipherStream::Tell()
+    i64 EcbCipherStream::Tell()
     {
-        return input_->Tell().get() - buffered_;
+        i64 const result = input_->Tell();
+
+        return (result >= 0) ? (result - static_cast<i64>(buffered_)) : result;
     }
 
-    StreamPosition EcbCipherStream::Size()
+    i64 EcbCipherStream::Size()
     {
         return input_->Size();
     }
@@ -71,7 +73,7 @@ namespace Iridium
                 return total;
             }
 
-            buffered_ = padding_;
+            buffered_ -= padding_;
             padding_ = 0;
 
             if (usize read = ReadBuffered(ptr, len))
@@ -91,7 +93,7 @@ namespace Iridium
         {
             usize read = input_->Read(ptr, body);
 
-            cipher_->Update(ptr, read & ~block_mask);
+            cipher_->UpdateParallel(ptr, read & ~block_mask);
 
             ptr = static_cast<u8*>(ptr) + read;
             len -= read;
@@ -123,6 +125,72 @@ namespace Iridium
         return total;
     }
 
+    usize EcbCipherStream::ReadBulk(void* ptr, usize len, u64 offset)
+    {
+        u8* output = static_cast<u8*>(ptr);
+
+        usize const block_mask = block_size_ - 1;
+        usize total = 0;
+
+        // Read the whole block covering the start, and copy out the part after offset
+        if (usize const head = static_cast<usize>(offset) & block_mask)
+        {
+            u8 block[sizeof(buffer_)];
+
+            usize const read = ReadBlockBulk(block, offset - head);
+
+            if (read <= head)
+                return 0;
+
+            usize const amount = std::min(len, read - head);
+
+            std::memcpy(output, block + head, amount);
+
+            output += amount;
+            offset += amount;
+            len -= amount;
+            total += amount;
+
+            if ((len == 0) || (read != block_size_))
+                return total;
+        }
+
+        // Whole blocks can be decrypted in place
+        if (usize const body = len & ~block_mask)
+        {
+            usize const read = input_->ReadBulk(output, body, offset);
+
+            cipher_->UpdateParallel(output, read & ~block_mask);
+
+            output += read;
+            offset += read;
+            len -= read;
+            total += read;
+
+            if (read != body)
+                return total;
+        }
+
+        // Same as the start, for a partial block at the end
+        if (len != 0)
+        {
+            u8 block[sizeof(buffer_)];
+
+            usize const amount = std::min(len, ReadBlockBulk(block, offset));
+
+            std::memcpy(output, block, amount);
+
+            total += amount;
+        }
+
+        return total;
+    }
+
+    bool EcbCipherStream::IsBulkSync() const
+    {
+        return input_->IsBulkSync();
+    }
+
     inline void EcbCipherStream::RefillBuffer()
     {
         buffered_ = input_->Read(buffer_, block_size_);
@@ -153,4 +221,15 @@ namespace Iridium
 
         return read;
     }
+
+    usize EcbCipherStream::ReadBlockBulk(u8* block, u64 offset)
+    {
+        usize const read = input_->ReadBulk(block, block_size_, offset);
+
+        // Same as RefillBuffer, a partial block at the end of the input isn't encrypted
+        if (read == block_size_)
+            cipher_->Update(block, block_size_);
+
+        return read;
+    }
 } // namespace Iridium
@@ -12,13 +12,19 @@ namespace Iridium
         EcbCipherStream(Rc<Stream> input, Ptr<Cipher> cipher);
         ~EcbCipherStream() override;
 
-        StreamPosition Seek(i64 offset, SeekWhence whence) override;
+        i64 Seek(i64 offset, SeekWhence whence) override;
 
-        StreamPosition Tell() override;
-        StreamPosition Size() override;
+        i64 Tell() override;
+        i64 Size() override;
 
         usize Read(void* ptr, usize len) override;
 
+        // Doesn't use the current position or buffer, so it can be called from multiple threads
+        // The cipher must not keep any state between blocks, which is true of ECB
+        usize ReadBulk(void* ptr, usize len, u64 offset) override;
+
+        bool IsBulkSync() const override;
+
     private:
         Rc<Stream> input_ {nullptr};
 
@@ -31,5 +37,7 @@ namespace Iridium
 
         void RefillBuffer();
         usize ReadBuffered(void* ptr, usize len);
+
+        usize ReadBlockBulk(u8* block, u64 offset);
     };
 } // namespace Iridium
@@ -19,12 +19,25 @@ namespace Iridium::Rage
 
         virtual usize Update(const u8* input, u8* output, usize length) override
         {
-            for (usize i = 0; i < 16; ++i)
+            for (usize i = 0; i < 16; ++i, input = output)
                 length = cipher_->Update(input, output, length);
 
             return length;
         }
 
+        virtual usize UpdateParallel(const u8* input, u8* output, usize length) override
+        {
+            // Split the input once, and run all 16 passes over each range
+            auto update = [&](usize offset, usize range_length) {
+                Update(input + offset, output + offset, range_length);
+            };
+
+            if (!ParallelCipherUpdate(length, cipher_->GetBlockSize(), update))
+                return Update(input, output, length);
+
+            return length;
+        }
+
         virtual usize GetBlockSize() override
         {
             return cipher_->GetBlockSize();
@@ -108,7 +121,7 @@ namespace Iridium::Rage
         if (Option<Ptr<Cipher>> cipher = MakeCipher())
         {
             if (*cipher)
-                (*cipher)->Update(entries_.data(), entries_.size() * sizeof(fiPackEntry6));
+                (*cipher)->UpdateParallel(entries_.data(), entries_.size() * sizeof(fiPackEntry6));
         }
         else
         {
@@ -254,8 +254,8 @@ namespace Iridium::Rage
 
             entries[0] = root;
 
-            cipher->Update(entries.data() + 1, (entries.size() - 1) * sizeof(fiPackEntry7));
-            cipher->Update(names.data(), names.size());
+            cipher->UpdateParallel(entries.data() + 1, (entries.size() - 1) * sizeof(fiPackEntry7));
+            cipher->UpdateParallel(names.data(), names.size());
         }
 
         for (fiPackEntry7& entry : entries)
@@ -315,6 +315,8 @@ namespace Iridium::Rage
         {
             IrAssert(!entry.IsResource() && entry.GetDecryptionTag() == 0, "Invalid Entry");
 
+            input_->Advise(offset, entry.GetSize(), AccessPattern::WillNeed);
+
             return MakeRc<PartialStream>(offset, entry.GetSize(), input_);
         }
 
@@ -358,6 +360,8 @@ namespace Iridium::Rage
             }
         }
 
+        input_->Advise(offset, raw_size, AccessPattern::WillNeed);
+
         Rc<Stream> result = MakeRc<PartialStream>(offset, raw_size, input_);
 
         if (cipher)
@@ -78,7 +78,7 @@ namespace Iridium::Rage
         {
             amount = (Pending >= amount) ? amount : (Pending & 0xFFFFFFF0);
 
-            Cipher->Update(&Output[Offset - start_offset], static_cast<usize>(amount));
+            Cipher->UpdateParallel(&Output[Offset - start_offset], static_cast<usize>(amount));
 
             Seek(amount);
 
@@ -717,7 +717,7 @@ namespace Iridium::Rage
         if (Option<Ptr<Cipher>> cipher = GetRPF8Cipher(header_.PlatformId, header_.DecryptionTag))
         {
             if (*cipher)
-                (*cipher)->Update(entries_.data(), entries_.size() * sizeof(fiPackEntry8));
+                (*cipher)->UpdateParallel(entries_.data(), entries_.size() * sizeof(fiPackEntry8));
         }
         else
         {
@@ -802,6 +802,8 @@ namespace Iridium::Rage
             raw_size = size;
         }
 
+        input_->Advise(offset, raw_size, AccessPattern::WillNeed);
+
         Rc<Stream> result = MakeRc<PartialStream>(offset, raw_size, input_);
 
         if (u8 const key = entry.GetEncryptionKeyId(); key != 0xFF)
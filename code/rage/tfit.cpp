@@ -1,60 +1,186 @@
 #include "tfit.h"
 
+#include "core/cpu.h"
+
+#if IR_ARCH_X86
+#    include <immintrin.h>
+#endif
+
 namespace Iridium
 {
-    static IR_FORCEINLINE void TFIT_DecryptRoundA(u8 data[16], const u32 key[4], const u32 table[16][256])
+    // Each round only depends on the previous one, so several blocks are decrypted together
+    // This keeps more table lookups in flight, hiding their latency (the tables are far larger than L1)
+
+    template <usize N>
+    static IR_FORCEINLINE void TFIT_DecryptRoundA(u8 (&data)[N][16], const u32 key[4], const u32 table[16][256])
     {
-        const u32 result[4] = {
-            table[0][data[0]] ^ table[1][data[1]] ^ table[2][data[2]] ^ table[3][data[3]] ^ key[0],
-            table[4][data[4]] ^ table[5][data[5]] ^ table[6][data[6]] ^ table[7][data[7]] ^ key[1],
-            table[8][data[8]] ^ table[9][data[9]] ^ table[10][data[10]] ^ table[11][data[11]] ^ key[2],
-            table[12][data[12]] ^ table[13][data[13]] ^ table[14][data[14]] ^ table[15][data[15]] ^ key[3],
-        };
+        u32 result[N][4];
+
+        for (usize i = 0; i < N; ++i)
+        {
+            const u8* block = data[i];
+
+            result[i][0] = table[0][block[0]] ^ table[1][block[1]] ^ table[2][block[2]] ^ table[3][block[3]] ^ key[0];
+            result[i][1] = table[4][block[4]] ^ table[5][block[5]] ^ table[6][block[6]] ^ table[7][block[7]] ^ key[1];
+            result[i][2] =
+                table[8][block[8]] ^ table[9][block[9]] ^ table[10][block[10]] ^ table[11][block[11]] ^ key[2];
+            result[i][3] =
+                table[12][block[12]] ^ table[13][block[13]] ^ table[14][block[14]] ^ table[15][block[15]] ^ key[3];
+        }
 
-        std::memcpy(data, result, 16);
+        std::memcpy(data, result, sizeof(result));
     }
 
-    static IR_FORCEINLINE void TFIT_DecryptRoundB(u8 data[16], const u32 key[4], const u32 table[16][256])
+    template <usize N>
+    static IR_FORCEINLINE void TFIT_DecryptRoundB(u8 (&data)[N][16], const u32 key[4], const u32 table[16][256])
     {
-        const u32 result[4] = {
-            table[0][data[0]] ^ table[1][data[7]] ^ table[2][data[10]] ^ table[3][data[13]] ^ key[0],
-            table[4][data[1]] ^ table[5][data[4]] ^ table[6][data[11]] ^ table[7][data[14]] ^ key[1],
-            table[8][data[2]] ^ table[9][data[5]] ^ table[10][data[8]] ^ table[11][data[15]] ^ key[2],
-            table[12][data[3]] ^ table[13][data[6]] ^ table[14][data[9]] ^ table[15][data[12]] ^ key[3],
-        };
+        u32 result[N][4];
 
-        std::memcpy(data, result, 16);
+        for (usize i = 0; i < N; ++i)
+        {
+            const u8* block = data[i];
+
+            result[i][0] = table[0][block[0]] ^ table[1][block[7]] ^ table[2][block[10]] ^ table[3][block[13]] ^ key[0];
+            result[i][1] = table[4][block[1]] ^ table[5][block[4]] ^ table[6][block[11]] ^ table[7][block[14]] ^ key[1];
+            result[i][2] =
+                table[8][block[2]] ^ table[9][block[5]] ^ table[10][block[8]] ^ table[11][block[15]] ^ key[2];
+            result[i][3] =
+                table[12][block[3]] ^ table[13][block[6]] ^ table[14][block[9]] ^ table[15][block[12]] ^ key[3];
+        }
+
+        std::memcpy(data, result, sizeof(result));
     }
 
-    static IR_FORCEINLINE void TFIT_DecryptBlock(
-        const u8 input[16], u8 output[16], const u32 keys[17][4], const u32 tables[17][16][256])
+    template <usize N>
+    static IR_FORCEINLINE void TFIT_DecryptBlocks(
+        const u8* input, u8* output, const u32 keys[17][4], const u32 tables[17][16][256])
     {
-        u8 temp[16];
-        std::memcpy(temp, input, 16);
+        u8 temp[N][16];
+        std::memcpy(temp, input, sizeof(temp));
 
         TFIT_DecryptRoundA(temp, keys[0], tables[0]);
         TFIT_DecryptRoundA(temp, keys[1], tables[1]);
 
-        TFIT_DecryptRoundB(temp, keys[2], tables[2]);
-        TFIT_DecryptRoundB(temp, keys[3], tables[3]);
-        TFIT_DecryptRoundB(temp, keys[4], tables[4]);
-        TFIT_DecryptRoundB(temp, keys[5], tables[5]);
-        TFIT_DecryptRoundB(temp, keys[6], tables[6]);
-        TFIT_DecryptRoundB(temp, keys[7], tables[7]);
-        TFIT_DecryptRoundB(temp, keys[8], tables[8]);
-        TFIT_DecryptRoundB(temp, keys[9], tables[9]);
-        TFIT_DecryptRoundB(temp, keys[10], tables[10]);
-        TFIT_DecryptRoundB(temp, keys[11], tables[11]);
-        TFIT_DecryptRoundB(temp, keys[12], tables[12]);
-        TFIT_DecryptRoundB(temp, keys[13], tables[13]);
-        TFIT_DecryptRoundB(temp, keys[14], tables[14]);
-        TFIT_DecryptRoundB(temp, keys[15], tables[15]);
+        for (usize i = 2; i < 16; ++i)
+            TFIT_DecryptRoundB(temp, keys[i], tables[i]);
 
         TFIT_DecryptRoundA(temp, keys[16], tables[16]);
 
-        std::memcpy(output, temp, 16);
+        std::memcpy(output, temp, sizeof(temp));
+    }
+
+    static void TFIT_DecryptBlocks_Scalar(
+        const u8* input, u8* output, usize blocks, const u32 keys[17][4], const u32 tables[17][16][256])
+    {
+        for (; blocks >= 4; blocks -= 4, input += 64, output += 64)
+            TFIT_DecryptBlocks<4>(input, output, keys, tables);
+
+        for (; blocks; --blocks, input += 16, output += 16)
+            TFIT_DecryptBlocks<1>(input, output, keys, tables);
+    }
+
+#if IR_ARCH_X86
+    // Byte shuffles which pick the table index for each word of the result, one for each of the 4 lookups
+    // Each 128-bit lane holds a separate block, which matches the lanes of vpshufb
+    struct TfitGatherIndices
+    {
+        u8 RoundA[4][32];
+        u8 RoundB[4][32];
+        u32 Offsets[4][8];
+    };
+
+    static constexpr TfitGatherIndices MakeTfitGatherIndices()
+    {
+        TfitGatherIndices result {};
+
+        for (usize k = 0; k < 4; ++k)
+        {
+            for (usize i = 0; i < 32; ++i)
+            {
+                usize const word = (i >> 2) & 3;
+                bool const low = (i & 3) == 0;
+
+                // Round A: word w uses bytes 4w to 4w+3
+                result.RoundA[k][i] = low ? u8(4 * word + k) : 0x80;
+
+                // Round B: word w uses byte w of word 0, w+3 of word 1, w+2 of word 2, w+1 of word 3
+                result.RoundB[k][i] = low ? u8(4 * k + ((word - k) & 3)) : 0x80;
+            }
+
+            for (usize i = 0; i < 8; ++i)
+                result.Offsets[k][i] = u32(4 * (i & 3) + k) * 256;
+        }
+
+        return result;
+    }
+
+    alignas(32) static constexpr TfitGatherIndices TFIT_GATHER_INDICES = MakeTfitGatherIndices();
+
+    IR_TARGET("avx2")
+    static IR_FORCEINLINE __m256i TFIT_GatherRound(
+        __m256i data, const u32 key[4], const u32 table[16][256], const u8 (&shuffles)[4][32])
+    {
+        const int* base = reinterpret_cast<const int*>(table);
+
+        __m256i result = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(key)));
+
+        for (usize k = 0; k < 4; ++k)
+        {
+            __m256i index = _mm256_shuffle_epi8(data, _mm256_load_si256(reinterpret_cast<const __m256i*>(shuffles[k])));
+            index = _mm256_add_epi32(
+                index, _mm256_load_si256(reinterpret_cast<const __m256i*>(TFIT_GATHER_INDICES.Offsets[k])));
+
+            result = _mm256_xor_si256(result, _mm256_i32gather_epi32(base, index, 4));
+        }
+
+        return result;
     }
 
+    // Decrypts 8 blocks at a time, 2 per register, using gathers for the table lookups
+    IR_TARGET("avx2")
+    static void TFIT_DecryptBlocks_AVX2(
+        const u8* input, u8* output, usize blocks, const u32 keys[17][4], const u32 tables[17][16][256])
+    {
+        const TfitGatherIndices& indices = TFIT_GATHER_INDICES;
+
+        for (; blocks >= 8; blocks -= 8, input += 128, output += 128)
+        {
+            __m256i data[4];
+
+            for (usize j = 0; j < 4; ++j)
+                data[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + 32 * j));
+
+            for (usize i = 0; i < 17; ++i)
+            {
+                const u8(&shuffles)[4][32] = ((i < 2) || (i == 16)) ? indices.RoundA : indices.RoundB;
+
+                for (usize j = 0; j < 4; ++j)
+                    data[j] = TFIT_GatherRound(data[j], keys[i], tables[i], shuffles);
+            }
+
+            for (usize j = 0; j < 4; ++j)
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + 32 * j), data[j]);
+        }
+
+        TFIT_DecryptBlocks_Scalar(input, output, blocks, keys, tables);
+    }
+#endif
+
+    using TfitDecryptFunc = void (*)(
+        const u8* input, u8* output, usize blocks, const u32 keys[17][4], const u32 tables[17][16][256]);
+
+    static TfitDecryptFunc SelectTfitDecrypt()
+    {
+#if IR_ARCH_X86
+        if (GetCpuFeatures().AVX2)
+            return TFIT_DecryptBlocks_AVX2;
+#endif
+
+        return TFIT_DecryptBlocks_Scalar;
+    }
+
+    static const TfitDecryptFunc TFIT_DecryptBlocks_Best = SelectTfitDecrypt();
+
     constexpr usize TFIT_BLOCK_SIZE = 16;
 
     TfitEcbCipher::TfitEcbCipher(const u32 keys[17][4], const u32 tables[17][16][256])
@@ -64,11 +190,19 @@ namespace Iridium
 
     usize TfitEcbCipher::Update(const u8* input, u8* output, usize length)
     {
-        for (usize blocks = length / TFIT_BLOCK_SIZE; blocks;
-             --blocks, input += TFIT_BLOCK_SIZE, output += TFIT_BLOCK_SIZE)
-        {
-            TFIT_DecryptBlock(input, output, keys_, tables_);
-        }
+        TFIT_DecryptBlocks_Best(input, output, length / TFIT_BLOCK_SIZE, keys_, tables_);
+
+        return length;
+    }
+
+    usize TfitEcbCipher::UpdateParallel(const u8* input, u8* output, usize length)
+    {
+        auto decrypt = [&](usize offset, usize range_length) {
+            TFIT_DecryptBlocks_Best(input + offset, output + offset, range_length / TFIT_BLOCK_SIZE, keys_, tables_);
+        };
+
+        if (!ParallelCipherUpdate(length, TFIT_BLOCK_SIZE, decrypt))
+            return Update(input, output, length);
 
         return length;
     }
@@ -87,26 +221,26 @@ namespace Iridium
 
     usize TfitCbcCipher::Update(const u8* input, u8* output, usize length)
     {
-        u8 iv[2][16];
-
-        u8* current_iv = iv_;
+        BatchedCbcDecrypt<TFIT_BLOCK_SIZE>(input, output, length, iv_,
+            [this](const u8* blocks_input, u8* blocks_output, usize blocks) {
+                TFIT_DecryptBlocks_Best(blocks_input, blocks_output, blocks, keys_, tables_);
+            });
 
-        for (usize blocks = length / TFIT_BLOCK_SIZE; blocks;
-             --blocks, input += TFIT_BLOCK_SIZE, output += TFIT_BLOCK_SIZE)
-        {
-            u8* const next_iv = iv[blocks & 1];
-
-            std::memcpy(next_iv, input, TFIT_BLOCK_SIZE);
-
-            TFIT_DecryptBlock(input, output, keys_, tables_);
+        return length;
+    }
 
-            for (usize j = 0; j < 16; ++j)
-                output[j] ^= current_iv[j];
+    usize TfitCbcCipher::UpdateParallel(const u8* input, u8* output, usize length)
+    {
+        auto decrypt_blocks = [this](const u8* blocks_input, u8* blocks_output, usize blocks) {
+            TFIT_DecryptBlocks_Best(blocks_input, blocks_output, blocks, keys_, tables_);
+        };
 
-            current_iv = next_iv;
-        }
+        auto decrypt = [&](const u8* range_input, u8* range_output, usize range_length, u8 iv[16]) {
+            BatchedCbcDecrypt<TFIT_BLOCK_SIZE>(range_input, range_output, range_length, iv, decrypt_blocks);
+        };
 
-        std::memcpy(iv_, current_iv, 16);
+        if (!ParallelCbcDecrypt(input, output, length, iv_, decrypt))
+            return Update(input, output, length);
 
         return length;
     }
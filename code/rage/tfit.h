@@ -10,6 +10,7 @@ namespace Iridium
         TfitEcbCipher(const u32 keys[17][4], const u32 tables[17][16][256]);
 
         usize Update(const u8* input, u8* output, usize length) override;
+        usize UpdateParallel(const u8* input, u8* output, usize length) override;
 
         usize GetBlockSize() override;
 
@@ -23,6 +24,7 @@ namespace Iridium
         TfitCbcCipher(const u32 keys[17][4], const u32 tables[17][16][256], const u8 iv[16]);
 
         usize Update(const u8* input, u8* output, usize length) override;
+        usize UpdateParallel(const u8* input, u8* output, usize length) override;
 
         usize GetBlockSize() override;
 
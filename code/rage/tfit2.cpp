@@ -2,8 +2,13 @@
 
 #include "asset/stream/buffered.h"
 
+#include "core/cpu.h"
 #include "crypto/buzhash.h"
 
+#if IR_ARCH_X86
+#    include <immintrin.h>
+#endif
+
 namespace Iridium
 {
     bool Tfit2Context::Load(BufferedStream& input)
@@ -283,6 +288,179 @@ namespace Iridium
         std::memcpy(output, temp, 16);
     }
 
+    static void TFIT2_DecryptBlocks_Scalar(
+        const Tfit2Context& ctx, const u64 keys[17][2], const u8* input, u8* output, usize blocks)
+    {
+        for (; blocks; --blocks, input += 16, output += 16)
+            TFIT2_DecryptBlock(ctx, keys, input, output);
+    }
+
+#if IR_ARCH_X86
+    // Each sub-block is a pair of GF(2) matrix products: the parity of each byte of XOR(masks[i] & splat(byte[7 - i]))
+    // Parity is linear, so 4 masks are applied per instruction and the lanes are only folded together at the end
+
+    // Splats bytes 7-4 (and 3-0) of each 64-bit half into the 4 lanes
+    alignas(32) static const u8 TFIT2_SPLAT_SHUFFLES[2][32] {
+        {7, 7, 7, 7, 7, 7, 7, 7, 6, 6, 6, 6, 6, 6, 6, 6, 5, 5, 5, 5, 5, 5, 5, 5, 4, 4, 4, 4, 4, 4, 4, 4},
+        {3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    };
+
+    // Parity of a nibble, in the top bit for movemask
+    alignas(32) static const u8 TFIT2_NIBBLE_PARITY[32] {
+        0x00, 0x80, 0x80, 0x00, 0x80, 0x00, 0x00, 0x80, 0x80, 0x00, 0x00, 0x80, 0x00, 0x80, 0x80, 0x00, //
+        0x00, 0x80, 0x80, 0x00, 0x80, 0x00, 0x00, 0x80, 0x80, 0x00, 0x00, 0x80, 0x00, 0x80, 0x80, 0x00, //
+    };
+
+    // Which half of the block is used by each sub-block, in rounds B and C
+    constexpr u16 TFIT2_ROUND_B_HALVES = 0xFF00;
+    constexpr u16 TFIT2_ROUND_C_HALVES = 0x39C6;
+
+    struct Tfit2Splats
+    {
+        __m256i Halves[2][2];
+    };
+
+    IR_TARGET("avx2")
+    static IR_FORCEINLINE void TFIT2_SplatHalves(const u8 data[16], Tfit2Splats& splats)
+    {
+        __m256i const upper = _mm256_load_si256(reinterpret_cast<const __m256i*>(TFIT2_SPLAT_SHUFFLES[0]));
+        __m256i const lower = _mm256_load_si256(reinterpret_cast<const __m256i*>(TFIT2_SPLAT_SHUFFLES[1]));
+
+        for (usize i = 0; i < 2; ++i)
+        {
+            u64 half;
+            std::memcpy(&half, data + 8 * i, 8);
+
+            __m256i const value = _mm256_set1_epi64x(static_cast<i64>(half));
+
+            splats.Halves[i][0] = _mm256_shuffle_epi8(value, upper);
+            splats.Halves[i][1] = _mm256_shuffle_epi8(value, lower);
+        }
+    }
+
+    IR_TARGET("avx2")
+    static IR_FORCEINLINE __m256i TFIT2_Product(const u64 masks[8], const __m256i splats[2])
+    {
+        return _mm256_xor_si256(
+            _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + 0)), splats[0]),
+            _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + 4)), splats[1]));
+    }
+
+    // Folds the lanes of each product, then returns the parity of each byte
+    // Bits 0-7 come from a, 8-15 from b, 16-23 from c, and 24-31 from d
+    IR_TARGET("avx2")
+    static IR_FORCEINLINE u32 TFIT2_Parity(__m256i a, __m256i b, __m256i c, __m256i d)
+    {
+        __m256i const ab = _mm256_xor_si256(_mm256_unpacklo_epi64(a, b), _mm256_unpackhi_epi64(a, b));
+        __m256i const cd = _mm256_xor_si256(_mm256_unpacklo_epi64(c, d), _mm256_unpackhi_epi64(c, d));
+
+        __m256i x = _mm256_xor_si256(_mm256_permute2x128_si256(ab, cd, 0x20), _mm256_permute2x128_si256(ab, cd, 0x31));
+
+        x = _mm256_xor_si256(x, _mm256_srli_epi16(x, 4));
+        x = _mm256_and_si256(x, _mm256_set1_epi8(0x0F));
+        x = _mm256_shuffle_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(TFIT2_NIBBLE_PARITY)), x);
+
+        return static_cast<u32>(_mm256_movemask_epi8(x));
+    }
+
+    IR_TARGET("avx2")
+    static IR_FORCEINLINE void TFIT2_DecryptRoundBC_AVX2(
+        const Tfit2Context::Round& round, const Tfit2Splats& splats, u16 halves, const u64 key[2], u8 data[16])
+    {
+        u64 values[2] {key[0], key[1]};
+
+        for (usize i = 0; i < 16; i += 2)
+        {
+            const Tfit2Context::Round::Block& block0 = round.Blocks[i];
+            const Tfit2Context::Round::Block& block1 = round.Blocks[i + 1];
+
+            const __m256i* splats0 = splats.Halves[(halves >> i) & 1];
+            const __m256i* splats1 = splats.Halves[(halves >> (i + 1)) & 1];
+
+            // The lower 8 bits of the index come from masks 8-15, and the upper 4 from masks 0-7
+            u32 const bits = TFIT2_Parity(TFIT2_Product(block0.Masks + 8, splats0),
+                TFIT2_Product(block0.Masks, splats0), TFIT2_Product(block1.Masks + 8, splats1),
+                TFIT2_Product(block1.Masks, splats1));
+
+            values[i >> 3] ^=
+                round.Lookup[(bits & 0xFFF) ^ block0.Xor] ^ round.Lookup[((bits >> 16) & 0xFFF) ^ block1.Xor];
+        }
+
+        std::memcpy(data, values, 16);
+    }
+
+    IR_TARGET("avx2")
+    static IR_FORCEINLINE void TFIT2_DecryptRoundD_AVX2(const Tfit2Context& ctx, const Tfit2Splats& splats, u8 data[16])
+    {
+        for (usize i = 0; i < 16; i += 4)
+        {
+            const __m256i* half = splats.Halves[i >> 3];
+
+            u32 const bits = TFIT2_Parity(TFIT2_Product(ctx.EndMasks[i + 0], half),
+                TFIT2_Product(ctx.EndMasks[i + 1], half), TFIT2_Product(ctx.EndMasks[i + 2], half),
+                TFIT2_Product(ctx.EndMasks[i + 3], half));
+
+            for (usize j = 0; j < 4; ++j)
+                data[i + j] = ctx.EndTables[i + j][static_cast<u8>(bits >> (8 * j)) ^ ctx.EndXor[i + j]];
+        }
+    }
+
+    // Decrypts 2 blocks at a time, to keep more of the (scalar) table lookups in flight
+    IR_TARGET("avx2")
+    static void TFIT2_DecryptBlocks_AVX2(
+        const Tfit2Context& ctx, const u64 keys[17][2], const u8* input, u8* output, usize blocks)
+    {
+        constexpr usize N = 2;
+
+        for (; blocks >= N; blocks -= N, input += 16 * N, output += 16 * N)
+        {
+            u8 temp[N][16];
+            std::memcpy(temp, input, sizeof(temp));
+
+            Tfit2Splats splats[N];
+
+            for (usize j = 0; j < N; ++j)
+                TFIT2_DecryptRoundA(ctx, temp[j]);
+
+            for (usize i = 0; i < 17; ++i)
+            {
+                u16 const halves = ((i < 2) || (i == 16)) ? TFIT2_ROUND_B_HALVES : TFIT2_ROUND_C_HALVES;
+
+                for (usize j = 0; j < N; ++j)
+                    TFIT2_SplatHalves(temp[j], splats[j]);
+
+                for (usize j = 0; j < N; ++j)
+                    TFIT2_DecryptRoundBC_AVX2(ctx.Rounds[i], splats[j], halves, keys[i], temp[j]);
+            }
+
+            for (usize j = 0; j < N; ++j)
+            {
+                TFIT2_SplatHalves(temp[j], splats[j]);
+                TFIT2_DecryptRoundD_AVX2(ctx, splats[j], temp[j]);
+            }
+
+            std::memcpy(output, temp, sizeof(temp));
+        }
+
+        TFIT2_DecryptBlocks_Scalar(ctx, keys, input, output, blocks);
+    }
+#endif
+
+    using Tfit2DecryptFunc = void (*)(
+        const Tfit2Context& ctx, const u64 keys[17][2], const u8* input, u8* output, usize blocks);
+
+    static Tfit2DecryptFunc SelectTfit2Decrypt()
+    {
+#if IR_ARCH_X86
+        if (GetCpuFeatures().AVX2)
+            return TFIT2_DecryptBlocks_AVX2;
+#endif
+
+        return TFIT2_DecryptBlocks_Scalar;
+    }
+
+    static const Tfit2DecryptFunc TFIT2_DecryptBlocks_Best = SelectTfit2Decrypt();
+
     constexpr usize TFIT2_BLOCK_SIZE = 16;
 
     Tfit2CbcCipher::Tfit2CbcCipher(const u64 keys[17][2], const u8 iv[16], const Tfit2Context* ctx)
@@ -294,26 +472,26 @@ namespace Iridium
 
     usize Tfit2CbcCipher::Update(const u8* input, u8* output, usize length)
     {
-        u8 iv[2][16];
-
-        u8* current_iv = iv_;
+        BatchedCbcDecrypt<TFIT2_BLOCK_SIZE>(input, output, length, iv_,
+            [this](const u8* blocks_input, u8* blocks_output, usize blocks) {
+                TFIT2_DecryptBlocks_Best(*ctx_, keys_, blocks_input, blocks_output, blocks);
+            });
 
-        for (usize blocks = length / TFIT2_BLOCK_SIZE; blocks;
-             --blocks, input += TFIT2_BLOCK_SIZE, output += TFIT2_BLOCK_SIZE)
-        {
-            u8* const next_iv = iv[blocks & 1];
-
-            std::memcpy(next_iv, input, TFIT2_BLOCK_SIZE);
-
-            TFIT2_DecryptBlock(*ctx_, keys_, input, output);
+        return length;
+    }
 
-            for (usize j = 0; j < 16; ++j)
-                output[j] ^= current_iv[j];
+    usize Tfit2CbcCipher::UpdateParallel(const u8* input, u8* output, usize length)
+    {
+        auto decrypt_blocks = [this](const u8* blocks_input, u8* blocks_output, usize blocks) {
+            TFIT2_DecryptBlocks_Best(*ctx_, keys_, blocks_input, blocks_output, blocks);
+        };
 
-            current_iv = next_iv;
-        }
+        auto decrypt = [&](const u8* range_input, u8* range_output, usize range_length, u8 iv[16]) {
+            BatchedCbcDecrypt<TFIT2_BLOCK_SIZE>(range_input, range_output, range_length, iv, decrypt_blocks);
+        };
 
-        std::memcpy(iv_, current_iv, 16);
+        if (!ParallelCbcDecrypt(input, output, length, iv_, decrypt))
+            return Update(input, output, length);
 
         return length;
     }
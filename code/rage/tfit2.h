@@ -62,6 +62,7 @@ namespace Iridium
         Tfit2CbcCipher(const u64 keys[17][2], const u8 iv[16], const Tfit2Context* ctx);
 
         usize Update(const u8* input, u8* output, usize length) override;
+        usize UpdateParallel(const u8* input, u8* output, usize length) override;
 
         usize GetBlockSize() override;
 
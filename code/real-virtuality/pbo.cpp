@@ -1,15 +1,22 @@
 #include "pbo.h"
 
+#include "asset/compressibility.h"
 #include "asset/path.h"
 #include "asset/stream/buffered.h"
 #include "asset/stream/decode.h"
+#include "asset/stream/encode.h"
 #include "asset/stream/partial.h"
 #include "asset/stringheap.h"
 #include "asset/transform/lzss.h"
 #include "core/bits.h"
+#include "core/mutex.h"
+#include "core/parallel.h"
 
 namespace Iridium
 {
+    static constexpr u32 PboPackingCprs = 0x43707273;
+    static constexpr u32 PboPackingVers = 0x56657273;
+
     struct PboEntry
     {
         u32 PackingMethod {0};
@@ -28,6 +35,8 @@ namespace Iridium
     PboArchive::PboArchive(Rc<Stream> input)
         : input_(std::move(input))
     {
+        vfs_.FileContext = this;
+
         RefreshFileList();
     }
 
@@ -60,7 +69,7 @@ namespace Iridium
 
             u32 raw_size = Entry.RawSize;
 
-            if (Entry.PackingMethod == 0x43707273)
+            if (Entry.PackingMethod == PboPackingCprs)
             {
                 if (raw_size >= 4)
                     raw_size -= 4; // 32-bit checksum
@@ -71,7 +80,7 @@ namespace Iridium
 
             switch (Entry.PackingMethod)
             {
-                case 0x43707273:
+                case PboPackingCprs:
                     result = MakeRc<DecodeStream>(std::move(result), MakeUnique<LzssTransform>(), Entry.Size);
                     break;
             }
@@ -99,7 +108,7 @@ namespace Iridium
 
         bool IsVers() const
         {
-            return (PackingMethod == 0x56657273) && (TimeStamp == 0) && (DataSize == 0);
+            return (PackingMethod == PboPackingVers) && (TimeStamp == 0) && (DataSize == 0);
         }
     };
 
@@ -107,7 +116,8 @@ namespace Iridium
 
     bool PboArchive::RefreshFileList()
     {
-        BufferedStream stream(input_);
+        BufferedStream stream(input_, 0x10000);
+        stream.SetReadAhead(2);
 
         if (!stream.TrySeek(0))
             return false;
@@ -163,4 +173,181 @@ namespace Iridium
 
         return true;
     }
+
+    struct PackedPboFile
+    {
+        Rc<Stream> Data;
+
+        u32 PackingMethod {0};
+        u32 OriginalSize {0};
+    };
+
+    static PackedPboFile PackPboFile(FileDevice& device, StringView file, u32 max_chain)
+    {
+        PackedPboFile result;
+
+        Rc<Stream> input = device.Open(file, true);
+
+        if (input == nullptr)
+            return result;
+
+        if ((max_chain != 0) && ShouldCompress(file, *input) && input->TrySeek(0))
+        {
+            Rc<Stream> packed = Stream::Temp();
+
+            u32 original_size = 0;
+
+            {
+                EncodeStream encoder(packed, MakeUnique<LzssEncodeTransform>(max_chain));
+                original_size = static_cast<u32>(input->CopyTo(encoder));
+                encoder.Flush();
+            }
+
+            // Incompressible files are stored instead, which is also faster to read back
+            if (packed->Size() < original_size)
+            {
+                result.Data = std::move(packed);
+                result.PackingMethod = PboPackingCprs;
+                result.OriginalSize = original_size;
+
+                return result;
+            }
+        }
+
+        if (!input->TrySeek(0))
+        {
+            input = nullptr;
+            input = device.Open(file, true);
+
+            if (input == nullptr)
+                return result;
+        }
+
+        result.Data = Stream::Temp();
+        input->CopyTo(*result.Data);
+
+        return result;
+    }
+
+    bool PboArchive::Save(Rc<FileDevice> device, Vec<String> files, Rc<Stream> output, u32 max_chain)
+    {
+        std::sort(files.begin(), files.end(), PathCompareLess);
+
+        usize const file_count = files.size();
+
+        Vec<String> names(file_count);
+
+        // The data follows the header, so its size has to be known before writing any data
+        usize header_size = (1 + sizeof(RawPboEntry) + 1) + (1 + sizeof(RawPboEntry));
+
+        for (usize i = 0; i < file_count; ++i)
+        {
+            names[i] = files[i];
+            std::replace(names[i].begin(), names[i].end(), '/', '\\');
+
+            header_size += names[i].size() + 1 + sizeof(RawPboEntry);
+        }
+
+        Vec<RawPboEntry> entries(file_count);
+
+        // Files are packed in any order, but their data has to be written in order
+        Vec<PackedPboFile> packed(file_count);
+        Mutex packed_lock;
+
+        // Only used while holding write_lock
+        Mutex write_lock;
+        usize next_write = 0;
+        u64 offset = header_size;
+
+        std::atomic_bool failed {false};
+
+        // Writes out files which have been packed, until reaching one which hasn't
+        auto const write_ready = [&] {
+            while (next_write < file_count)
+            {
+                PackedPboFile ready;
+
+                {
+                    MutexGuard lock(packed_lock);
+
+                    if (packed[next_write].Data == nullptr)
+                        break;
+
+                    ready = std::move(packed[next_write]);
+                }
+
+                i64 const data_size = ready.Data->Size();
+
+                if ((data_size < 0) || (data_size > UINT32_MAX) || !ready.Data->TrySeek(0) ||
+                    !output->TrySeek(offset) || (ready.Data->CopyTo(*output) != static_cast<u64>(data_size)))
+                    return false;
+
+                RawPboEntry& entry = entries[next_write++];
+
+                entry.PackingMethod = ready.PackingMethod;
+                entry.OriginalSize = ready.OriginalSize;
+                entry.DataSize = static_cast<u32>(data_size);
+
+                offset += static_cast<u64>(data_size);
+            }
+
+            return true;
+        };
+
+        parallel_for_each(files.begin(), files.end(), [&](const String& file) {
+            PackedPboFile result = PackPboFile(*device, file, max_chain);
+
+            if (result.Data == nullptr)
+            {
+                failed = true;
+
+                return false;
+            }
+
+            {
+                MutexGuard lock(packed_lock);
+
+                packed[static_cast<usize>(&file - files.data())] = std::move(result);
+            }
+
+            // If another thread is already writing, it will pick this file up once it gets to it
+            UniqueLock<Mutex> writer(write_lock, std::try_to_lock);
+
+            if (writer.owns_lock() && !write_ready())
+                failed = true;
+
+            return !failed;
+        });
+
+        // Files which finished just as the last write did are still waiting
+        if (failed || !write_ready() || (next_write != file_count))
+            return false;
+
+        Vec<u8> header;
+        header.reserve(header_size);
+
+        auto const write_entry = [&header](StringView name, const RawPboEntry& entry) {
+            header.insert(header.end(), name.begin(), name.end());
+            header.emplace_back('\0');
+
+            const u8* data = reinterpret_cast<const u8*>(&entry);
+            header.insert(header.end(), data, data + sizeof(entry));
+        };
+
+        RawPboEntry const terminator {};
+
+        RawPboEntry vers {};
+        vers.PackingMethod = PboPackingVers;
+
+        // Vers header, with an empty list of extensions
+        write_entry("", vers);
+        header.emplace_back('\0');
+
+        for (usize i = 0; i < file_count; ++i)
+            write_entry(names[i], entries[i]);
+
+        write_entry("", terminator);
+
+        return output->TryWriteBulk(header.data(), header.size(), 0);
+    }
 } // namespace Iridium
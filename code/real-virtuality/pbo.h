@@ -11,6 +11,11 @@ namespace Iridium
 
         bool RefreshFileList();
 
+        // Writes the files into a new archive, compressing them in parallel
+        // max_chain trades compression for speed (see LzssEncodeTransform), with 0 storing every file as is
+        // Returns false if any of the files could not be read, or the output could not be written
+        static bool Save(Rc<FileDevice> device, Vec<String> files, Rc<Stream> output, u32 max_chain = 64);
+
         const Rc<Stream>& GetInput() const
         {
             return input_;